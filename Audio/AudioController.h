@@ -16,6 +16,10 @@
 #import "NVLowpassFilter.h"
 
 #import "CircularBuffer.h"
+#import "Denormals.h"
+#import "Limiter.h"
+#import "MultibandDistortion.h"
+#import "PhaseVocoder.h"
 
 #define kAudioSampleRate        44100.0
 #define kAudioBytesPerPacket    4
@@ -27,6 +31,10 @@
 
 #define kMaxDelayTime 2.0
 
+/* Sample storage for the scope histories and the delay line. Int16/Float16 halve the memory (and cache footprint) of Float32; see SampleConversion.h for accuracy */
+#define kHistoryStorageFormat kSampleStorageFloat32
+#define kDelayStorageFormat kSampleStorageFloat32
+
 #pragma mark -
 #pragma mark AudioController
 @interface AudioController : NSObject {
@@ -41,6 +49,9 @@
     /* Filters */
     NVLowpassFilter *lpf;
     NVHighpassFilter *hpf;
+    
+    /* Pitch shifter */
+    PhaseVocoder *pitchShifter;
 
     AUGraph graph;
     AudioUnit remoteIOUnit;
@@ -51,15 +62,16 @@
     UInt32 bufferSizeFrames;
     
     Float32 clippingAmplitude;
+    MultibandDistortion *multiband;     // Per-band clipping when multibandEnabled
     Float32 preGain;
     Float32 postGain;
     
     AudioStreamBasicDescription IOStreamFormat;
     Float32 hardwareSampleRate;
     
-    Float32 *inputBuffer;               // Pre-processing
+    CircularBuffer *inputBuffer;        // Pre-processing
     pthread_mutex_t inputBufferMutex;
-    Float32 *outputBuffer;              // Post-processing
+    CircularBuffer *outputBuffer;       // Post-processing
     pthread_mutex_t outputBufferMutex;
     
     Float32 *modulationBuffer;
@@ -68,11 +80,15 @@
     CircularBuffer *circularBuffer;
     pthread_mutex_t circularBufferMutex;
     Float32 tapGains[kMaxNumDelayTaps];
+    
+    /* Output limiter */
+    Limiter *limiter;
 }
 
 @property Float32 hardwareSampleRate;
 
 @property (readonly) int bufferLength;
+@property (readonly) SampleStorageFormat historyStorageFormat;
 
 @property (readonly) bool inputEnabled;
 @property (readonly) bool outputEnabled;
@@ -80,10 +96,13 @@
 @property (readonly) bool isInitialized;
 
 @property bool distortionEnabled;
+@property bool multibandEnabled;
 @property bool hpfEnabled;
 @property bool lpfEnabled;
 @property bool modulationEnabled;
+@property (nonatomic) bool pitchShiftEnabled;
 @property bool delayEnabled;
+@property (nonatomic) bool limiterEnabled;
 
 /* Start/stop audio */
 - (void)startAUGraph;
@@ -93,6 +112,12 @@
 - (void)setInputEnabled: (bool)enabled;
 - (void)setOutputEnabled:(bool)enabled;
 
+/* Reallocate the pre/post-processing histories. A compact format allows a longer history at the same memory cost */
+- (void)setHistoryStorageFormat:(SampleStorageFormat)format lengthInSeconds:(float)seconds;
+
+/* Bytes allocated for the pre/post-processing histories and delay line */
+- (size_t)memoryFootprint;
+
 /* Append to and read most recent data from the internal buffers */
 - (void)appendInputBuffer:(Float32 *)inBuffer withLength:(int)length;
 - (void)appendOutputBuffer:(Float32 *)inBuffer withLength:(int)length;
@@ -103,5 +128,15 @@
 /* Setters */
 - (void)rescaleFilters:(float)minFreq max:(float)maxFreq;
 - (void)setModFrequency:(float)freq;
+- (void)setLimiterLookahead:(float)milliseconds;
+- (void)setMultibandNumBands:(int)nBands;
+- (void)setPitchShiftRatio:(float)ratio;
+- (void)setPitchShiftSemitones:(float)semitones;
+
+/* Output latency in samples added by the limiter's look-ahead (0 if disabled) */
+- (int)limiterLatency;
+
+/* Output latency in samples added by the pitch shifter's analysis frame (0 if disabled) */
+- (int)pitchShiftLatency;
 
 @end
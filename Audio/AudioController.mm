@@ -21,6 +21,9 @@ static OSStatus processingCallback(void *inRefCon, // Reference to the calling o
 	/* Cast void to AudioController input object */
 	AudioController *controller = (__bridge AudioController *)inRefCon;
     
+    /* Flush subnormals to zero on the render thread while processing (restored before returning) */
+    DenormalMode previousDenormalMode = denormalsDisable();
+    
     /* Copy samples from input bus into the ioData (buffer to output) */
     status = AudioUnitRender(controller->remoteIOUnit,
                              ioActionFlags,
@@ -68,7 +71,10 @@ static OSStatus processingCallback(void *inRefCon, // Reference to the calling o
     /* ---------------- */
     /* == Distortion == */
     /* ---------------- */
-    if (controller.distortionEnabled) {
+    if (controller.distortionEnabled && controller.multibandEnabled)
+        multibandProcess(controller->multiband, procBuffer, inNumberFrames, controller->clippingAmplitude);
+    
+    else if (controller.distortionEnabled) {
         
         for (int i = 0; i < inNumberFrames; i++) {
             
@@ -90,11 +96,19 @@ static OSStatus processingCallback(void *inRefCon, // Reference to the calling o
     if (controller.lpfEnabled)
         [controller->lpf filterContiguousData:procBuffer numFrames:inNumberFrames channel:0];
     
+    /* ----------------- */
+    /* == Pitch Shift == */
+    /* ----------------- */
+    
+    if (controller.pitchShiftEnabled)
+        phaseVocoderProcess(controller->pitchShifter, procBuffer, inNumberFrames);
+    
     /* ----------- */
     /* == Delay == */
     /* ----------- */
     
-    /* Copy the processing buffer to the circular buffer */
+    /* Copy the processing buffer to the circular buffer, flushing decaying filter tails so the delay line never stores subnormals */
+    flushDenormals(procBuffer, inNumberFrames);
     [controller->circularBuffer writeDataWithLength:inNumberFrames inData:procBuffer];
     
     if (controller.delayEnabled) {
@@ -135,11 +149,21 @@ static OSStatus processingCallback(void *inRefCon, // Reference to the calling o
             procBuffer[i] *= 0;
     }
     
+    /* ------------- */
+    /* == Limiter == */
+    /* ------------- */
+    
+    /* Keep post-gain and summed delay taps from clipping at the DAC */
+    if (controller.limiterEnabled)
+        limiterProcess(controller->limiter, procBuffer, inNumberFrames);
+    
     /* Copy the processing buffer into the left and right output channels */
     memcpy((Float32 *)ioData->mBuffers[0].mData, procBuffer, inNumberFrames * sizeof(Float32));
     memcpy((Float32 *)ioData->mBuffers[1].mData, procBuffer, inNumberFrames * sizeof(Float32));
     
     free(procBuffer);
+    
+    denormalsRestore(previousDenormalMode);
 	return status;
 }
 
@@ -159,6 +183,7 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
 @synthesize hardwareSampleRate;
 
 @synthesize bufferLength;
+@synthesize historyStorageFormat;
 
 @synthesize inputEnabled;
 @synthesize outputEnabled;
@@ -166,10 +191,13 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
 @synthesize isInitialized;
 
 @synthesize distortionEnabled;
+@synthesize multibandEnabled;
 @synthesize hpfEnabled;
 @synthesize lpfEnabled;
 @synthesize modulationEnabled;
+@synthesize pitchShiftEnabled;
 @synthesize delayEnabled;
+@synthesize limiterEnabled;
 
 - (id)init {
     
@@ -183,22 +211,28 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
         isInitialized = false;
         isRunning = false;
         distortionEnabled = false;
+        multibandEnabled = false;
         hpfEnabled = false;
         lpfEnabled = false;
         modulationEnabled = false;
+        pitchShiftEnabled = false;
         delayEnabled = false;
+        limiterEnabled = true;
         
         /* Defaults */
         preGain = 1.0;
         postGain = 1.0;
         clippingAmplitude = 1.0;
         
-        bufferLength = kMaxDelayTime * kAudioSampleRate;
-        
-        [self allocateBuffersWithLength:bufferLength];
+        pthread_mutex_init(&inputBufferMutex, NULL);
+        pthread_mutex_init(&outputBufferMutex, NULL);
+        [self allocateBuffersWithLength:kMaxDelayTime * kAudioSampleRate storageFormat:kHistoryStorageFormat];
         [self setUpFilters];
+        [self setUpMultiband];
         [self setUpRingModulator];
+        [self setUpPitchShifter];
         [self setUpDelay];
+        [self setUpLimiter];
         [self setUpAUGraph];
     }
     
@@ -207,28 +241,35 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
 
 - (void)dealloc {
     
-    if (inputBuffer)
-        free(inputBuffer);
-    if (outputBuffer)
-        free(outputBuffer);
-    
     pthread_mutex_destroy(&inputBufferMutex);
     pthread_mutex_destroy(&outputBufferMutex);
+    
+    limiterDestroy(limiter);
+    multibandDestroy(multiband);
+    phaseVocoderDestroy(pitchShifter);
 }
 
-- (void)allocateBuffersWithLength:(int)length {
-    
-    if (inputBuffer)
-        free(inputBuffer);
-    
-    inputBuffer  = (Float32 *)calloc(length, sizeof(Float32));
-    pthread_mutex_init(&inputBufferMutex, NULL);
+- (void)allocateBuffersWithLength:(int)length storageFormat:(SampleStorageFormat)format {
     
-    if (outputBuffer)
-        free(outputBuffer);
-    
-    outputBuffer = (Float32 *)calloc(length, sizeof(Float32));
-    pthread_mutex_init(&outputBufferMutex, NULL);
+    /* Allocate before locking and only swap the pointers under the locks. The old buffers are released after unlocking so the render thread never waits on an allocation or free */
+    CircularBuffer *newInput = [[CircularBuffer alloc] initWithLength:length storageFormat:format];
+    CircularBuffer *newOutput = [[CircularBuffer alloc] initWithLength:length storageFormat:format];
+    CircularBuffer *oldInput, *oldOutput;
+
+    /* Both locks (always input first) so the buffers, length and format change together */
+    pthread_mutex_lock(&inputBufferMutex);
+    pthread_mutex_lock(&outputBufferMutex);
+    oldInput = inputBuffer;
+    oldOutput = outputBuffer;
+    inputBuffer = newInput;
+    outputBuffer = newOutput;
+    bufferLength = length;
+    historyStorageFormat = format;
+    pthread_mutex_unlock(&outputBufferMutex);
+    pthread_mutex_unlock(&inputBufferMutex);
+
+    oldInput = nil;
+    oldOutput = nil;
 }
 
 - (void)setUpFilters {
@@ -242,6 +283,12 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
     lpf.cornerFrequency = 20000;
 }
 
+- (void)setUpMultiband {
+    
+    multiband = multibandCreate(kAudioSampleRate);
+    multibandSetNumBands(multiband, kMultibandDefaultBands);
+}
+
 - (void)setUpRingModulator {
     
     modFreq = 440;
@@ -253,9 +300,16 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
     pthread_mutex_init(&modulationBufferMutex, NULL);
 }
 
+- (void)setUpPitchShifter {
+    
+    pitchShifter = phaseVocoderCreate(kPhaseVocoderDefaultFFTSize, kPhaseVocoderDefaultOverlap);
+    phaseVocoderSetTransientPreserving(pitchShifter, true);
+}
+
 - (void)setUpDelay {
     
-    circularBuffer = [[CircularBuffer alloc] initWithLength:(int)(kAudioSampleRate * kMaxDelayTime)];
+    circularBuffer = [[CircularBuffer alloc] initWithLength:(int)(kAudioSampleRate * kMaxDelayTime)
+                                              storageFormat:kDelayStorageFormat];
     [circularBuffer addDelayTapForSampleDelay:(int)(kAudioSampleRate * 1.0)];
     tapGains[0] = 0.8;
     tapGains[1] = 0.5;
@@ -264,6 +318,14 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
     tapGains[4] = 0.5;
 }
 
+- (void)setUpLimiter {
+    
+    limiter = limiterCreate(kAudioSampleRate);
+    limiterSetLookahead(limiter, kLimiterDefaultLookahead);
+    limiterSetRelease(limiter, kLimiterDefaultRelease);
+    limiterSetCeiling(limiter, kLimiterDefaultCeiling);
+}
+
 - (void)setUpAUGraph {
     
     NSLog(@"%s", __PRETTY_FUNCTION__);
@@ -523,47 +585,66 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
 //        [self startAUGraph];
 }
 
-/* Internal pre/post processing buffer setters/getters */
-- (void)appendInputBuffer:(Float32 *)inBuffer withLength:(int)length {
+/* Reallocate the pre/post-processing histories with a given storage format and length */
+- (void)setHistoryStorageFormat:(SampleStorageFormat)format lengthInSeconds:(float)seconds {
     
-    pthread_mutex_lock(&inputBufferMutex);
+    [self allocateBuffersWithLength:seconds * kAudioSampleRate storageFormat:format];
+}
+
+/* History length and format are written under the buffer locks, so read them there too */
+- (int)bufferLength {
     
-    /* Shift old values back */
-    for (int i = 0; i < bufferLength - length; i++)
-        inputBuffer[i] = inputBuffer[i + length];
+    pthread_mutex_lock(&inputBufferMutex);
+    int length = bufferLength;
+    pthread_mutex_unlock(&inputBufferMutex);
     
-    /* Append new values to the front */
-    for (int i = 0; i < length; i++)
-        inputBuffer[bufferLength - (length-i)] = inBuffer[i];
+    return length;
+}
+
+- (SampleStorageFormat)historyStorageFormat {
     
+    pthread_mutex_lock(&inputBufferMutex);
+    SampleStorageFormat format = historyStorageFormat;
     pthread_mutex_unlock(&inputBufferMutex);
+    
+    return format;
 }
-- (void)appendOutputBuffer:(Float32 *)inBuffer withLength:(int)length {
+
+/* Bytes allocated for the pre/post-processing histories and delay line */
+- (size_t)memoryFootprint {
     
+    pthread_mutex_lock(&inputBufferMutex);
     pthread_mutex_lock(&outputBufferMutex);
+    size_t bytes = [inputBuffer memoryFootprint] + [outputBuffer memoryFootprint];
+    pthread_mutex_unlock(&outputBufferMutex);
+    pthread_mutex_unlock(&inputBufferMutex);
     
-    /* Shift old values back */
-    for (int i = 0; i < bufferLength - length; i++)
-        outputBuffer[i] = outputBuffer[i + length];
+    return bytes + [circularBuffer memoryFootprint];
+}
+
+/* Internal pre/post processing buffer setters/getters */
+- (void)appendInputBuffer:(Float32 *)inBuffer withLength:(int)length {
     
-    /* Append new values to the front */
-    for (int i = 0; i < length; i++)
-        outputBuffer[bufferLength - (length-i)] = inBuffer[i];
+    pthread_mutex_lock(&inputBufferMutex);
+    [inputBuffer writeDataWithLength:length inData:inBuffer];
+    pthread_mutex_unlock(&inputBufferMutex);
+}
+- (void)appendOutputBuffer:(Float32 *)inBuffer withLength:(int)length {
     
+    pthread_mutex_lock(&outputBufferMutex);
+    [outputBuffer writeDataWithLength:length inData:inBuffer];
     pthread_mutex_unlock(&outputBufferMutex);
 }
 - (void)getInputBuffer:(Float32 *)outBuffer withLength:(int)length {
     
     pthread_mutex_lock(&inputBufferMutex);
-    for (int i = 0; i < length; i++)
-        outBuffer[i] = inputBuffer[bufferLength - (length-i)];
+    [inputBuffer readMostRecentWithLength:length outData:outBuffer];
     pthread_mutex_unlock(&inputBufferMutex);
 }
 - (void)getOutputBuffer:(Float32 *)outBuffer withLength:(int)length {
     
     pthread_mutex_lock(&outputBufferMutex);
-    for (int i = 0; i < length; i++)
-        outBuffer[i] = outputBuffer[bufferLength - (length-i)];
+    [outputBuffer readMostRecentWithLength:length outData:outBuffer];
     pthread_mutex_unlock(&outputBufferMutex);
 }
 
@@ -590,6 +671,57 @@ void interruptListener(void *inUserData, UInt32 inInterruptionState) {
     modThetaInc = 2.0 * M_PI * modFreq / kAudioSampleRate;
 }
 
+/* Set the number of multiband distortion bands with default crossovers */
+- (void)setMultibandNumBands:(int)nBands {
+    
+    multibandSetNumBands(multiband, nBands);
+}
+
+/* Enable/disable the pitch shifter, clearing its frame and overlap-add history so stale audio isn't replayed */
+- (void)setPitchShiftEnabled:(bool)enabled {
+    
+    if (enabled && !pitchShiftEnabled)
+        phaseVocoderReset(pitchShifter);
+    
+    pitchShiftEnabled = enabled;
+}
+
+/* Set the pitch ratio in [kPhaseVocoderMinPitchRatio, kPhaseVocoderMaxPitchRatio] (2.0 = up an octave) */
+- (void)setPitchShiftRatio:(float)ratio {
+    
+    phaseVocoderSetPitchRatio(pitchShifter, ratio);
+}
+
+- (void)setPitchShiftSemitones:(float)semitones {
+    
+    [self setPitchShiftRatio:powf(2.0f, semitones / 12.0f)];
+}
+
+- (int)pitchShiftLatency {
+    
+    return pitchShiftEnabled ? phaseVocoderGetLatency(pitchShifter) : 0;
+}
+
+/* Enable/disable the output limiter, clearing its look-ahead delay line so stale samples aren't replayed */
+- (void)setLimiterEnabled:(bool)enabled {
+    
+    if (enabled && !limiterEnabled)
+        limiterReset(limiter);
+    
+    limiterEnabled = enabled;
+}
+
+/* Set the limiter look-ahead in [kLimiterMinLookahead, kLimiterMaxLookahead] ms */
+- (void)setLimiterLookahead:(float)milliseconds {
+    
+    limiterSetLookahead(limiter, milliseconds);
+}
+
+- (int)limiterLatency {
+    
+    return limiterEnabled ? limiterGetLatency(limiter) : 0;
+}
+
 #pragma mark Utility Methods
 - (void)printErrorMessage:(NSString *)errorString withStatus:(OSStatus)result {
     
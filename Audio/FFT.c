@@ -0,0 +1,193 @@
+//
+//  FFT.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+#include "FFT.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct FFTPlan {
+
+    int size;               // Real transform length N
+    int halfSize;           // Complex transform length M = N/2
+
+    int *bitReverse;        // Length M
+    float *twiddleReal;     // cos/sin(2*pi*k/M), k < M/2
+    float *twiddleImag;
+    float *splitReal;       // cos/sin(2*pi*k/N), k <= M, for packing/unpacking the real transform
+    float *splitImag;
+
+    float *scratchReal;     // Length M
+    float *scratchImag;
+};
+
+FFTPlan *fftPlanCreate(int size) {
+
+    if (size < 4 || (size & (size - 1)))
+        return NULL;
+
+    FFTPlan *plan = (FFTPlan *)calloc(1, sizeof(FFTPlan));
+    plan->size = size;
+    plan->halfSize = size / 2;
+
+    int M = plan->halfSize;
+    int log2M = 0;
+    while ((1 << log2M) < M)
+        log2M++;
+
+    plan->bitReverse = (int *)malloc(M * sizeof(int));
+    for (int i = 0; i < M; i++) {
+        int r = 0;
+        for (int b = 0; b < log2M; b++)
+            r |= ((i >> b) & 1) << (log2M - 1 - b);
+        plan->bitReverse[i] = r;
+    }
+
+    plan->twiddleReal = (float *)malloc((M / 2 + 1) * sizeof(float));
+    plan->twiddleImag = (float *)malloc((M / 2 + 1) * sizeof(float));
+    for (int k = 0; k <= M / 2; k++) {
+        plan->twiddleReal[k] = cos(2.0 * M_PI * k / M);
+        plan->twiddleImag[k] = sin(2.0 * M_PI * k / M);
+    }
+
+    plan->splitReal = (float *)malloc((M + 1) * sizeof(float));
+    plan->splitImag = (float *)malloc((M + 1) * sizeof(float));
+    for (int k = 0; k <= M; k++) {
+        plan->splitReal[k] = cos(2.0 * M_PI * k / size);
+        plan->splitImag[k] = sin(2.0 * M_PI * k / size);
+    }
+
+    plan->scratchReal = (float *)malloc(M * sizeof(float));
+    plan->scratchImag = (float *)malloc(M * sizeof(float));
+
+    return plan;
+}
+
+void fftPlanDestroy(FFTPlan *plan) {
+
+    if (!plan)
+        return;
+
+    free(plan->bitReverse);
+    free(plan->twiddleReal);
+    free(plan->twiddleImag);
+    free(plan->splitReal);
+    free(plan->splitImag);
+    free(plan->scratchReal);
+    free(plan->scratchImag);
+    free(plan);
+}
+
+int fftPlanGetSize(FFTPlan *plan) {
+
+    return plan->size;
+}
+
+/* In-place iterative radix-2 complex FFT of length M on data already in bit-reversed order. sign = -1 forward, +1 inverse */
+static void complexFFT(FFTPlan *plan, float *re, float *im, float sign) {
+
+    int M = plan->halfSize;
+
+    for (int span = 1; span < M; span <<= 1) {
+
+        int stride = M / (2 * span);
+
+        for (int start = 0; start < M; start += 2 * span) {
+            for (int j = 0; j < span; j++) {
+
+                float wr = plan->twiddleReal[j * stride];
+                float wi = sign * plan->twiddleImag[j * stride];
+
+                int a = start + j;
+                int b = a + span;
+
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void fftForwardReal(FFTPlan *plan, const float *in, float *outReal, float *outImag) {
+
+    int M = plan->halfSize;
+    float *zr = plan->scratchReal;
+    float *zi = plan->scratchImag;
+
+    /* Pack even/odd samples as real/imaginary parts, in bit-reversed order */
+    for (int n = 0; n < M; n++) {
+        int r = plan->bitReverse[n];
+        zr[r] = in[2 * n];
+        zi[r] = in[2 * n + 1];
+    }
+
+    complexFFT(plan, zr, zi, -1.0f);
+
+    /* Separate the even/odd spectra and combine: X[k] = E[k] + e^{-2 pi i k/N} O[k] */
+    for (int k = 0; k <= M; k++) {
+
+        int a = (k == M) ? 0 : k;
+        int b = (k == 0) ? 0 : M - k;
+
+        float er = 0.5f * (zr[a] + zr[b]);
+        float ei = 0.5f * (zi[a] - zi[b]);
+        float or_ = 0.5f * (zi[a] + zi[b]);
+        float oi = -0.5f * (zr[a] - zr[b]);
+
+        float wr = plan->splitReal[k];
+        float wi = -plan->splitImag[k];
+
+        outReal[k] = er + wr * or_ - wi * oi;
+        outImag[k] = ei + wr * oi + wi * or_;
+    }
+}
+
+void fftInverseReal(FFTPlan *plan, const float *inReal, const float *inImag, float *out) {
+
+    int M = plan->halfSize;
+    float *zr = plan->scratchReal;
+    float *zi = plan->scratchImag;
+
+    /* Recover E[k] and O[k] from X[k] and X[M-k], repack as Z[k] = E[k] + i O[k] in bit-reversed order */
+    for (int k = 0; k < M; k++) {
+
+        float xr = inReal[k], xi = inImag[k];
+        float yr = inReal[M - k], yi = -inImag[M - k];     // conj(X[M-k])
+
+        float er = 0.5f * (xr + yr);
+        float ei = 0.5f * (xi + yi);
+
+        float dr = 0.5f * (xr - yr);
+        float di = 0.5f * (xi - yi);
+        float wr = plan->splitReal[k];
+        float wi = plan->splitImag[k];
+        float or_ = dr * wr - di * wi;
+        float oi = dr * wi + di * wr;
+
+        int r = plan->bitReverse[k];
+        zr[r] = er - oi;
+        zi[r] = ei + or_;
+    }
+
+    complexFFT(plan, zr, zi, 1.0f);
+
+    float scale = 1.0f / M;
+    for (int n = 0; n < M; n++) {
+        out[2 * n] = zr[n] * scale;
+        out[2 * n + 1] = zi[n] * scale;
+    }
+}
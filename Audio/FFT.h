@@ -0,0 +1,38 @@
+//
+//  FFT.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Portable real FFT. A plan precomputes the bit-reversal table and twiddles for a power-of-two size and owns its scratch memory, so transforms never allocate. The real transform packs the input into a half-size complex FFT.
+ */
+
+#ifndef DigitalSoundFX_FFT_h
+#define DigitalSoundFX_FFT_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FFTPlan FFTPlan;
+
+/* Create a plan for a power-of-two size >= 4. Returns NULL for invalid sizes */
+FFTPlan *fftPlanCreate(int size);
+void fftPlanDestroy(FFTPlan *plan);
+
+int fftPlanGetSize(FFTPlan *plan);
+
+/* Real input of length size -> size/2 + 1 complex bins (unnormalized) */
+void fftForwardReal(FFTPlan *plan, const float *in, float *outReal, float *outImag);
+
+/* size/2 + 1 complex bins -> real output of length size (scaled by 1/size, so inverse(forward(x)) == x) */
+void fftInverseReal(FFTPlan *plan, const float *inReal, const float *inImag, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
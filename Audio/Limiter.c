@@ -0,0 +1,213 @@
+//
+//  Limiter.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+#include "Limiter.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+struct Limiter {
+
+    float sampleRate;
+    float ceiling;
+    float releaseCoeff;
+
+    int capacity;           // Allocated window length (maximum look-ahead + 1)
+    int windowLength;       // Current window length (look-ahead + 1)
+    int pendingWindowLength;
+    int resetPending;
+
+    /* Look-ahead delay line and box-average history of the required gain share one write index */
+    float *delayLine;
+    float *gainHistory;
+    int writeIdx;
+    double gainSum;
+
+    /* Monotonic deque of (peak, sample index) pairs, decreasing in peak from front to back. Indices wrap at 2^32; only their differences (ages under the window length) are used */
+    float *dequeValues;
+    uint32_t *dequeIndices;
+    int dequeFront;
+    int dequeCount;
+    uint32_t sampleCount;
+
+    float gain;
+};
+
+static int lookaheadToWindowLength(float sampleRate, float milliseconds) {
+
+    if (milliseconds < kLimiterMinLookahead)
+        milliseconds = kLimiterMinLookahead;
+    if (milliseconds > kLimiterMaxLookahead)
+        milliseconds = kLimiterMaxLookahead;
+
+    return (int)(milliseconds * 0.001f * sampleRate + 0.5f) + 1;
+}
+
+static void clearState(Limiter *limiter) {
+
+    memset(limiter->delayLine, 0, limiter->capacity * sizeof(float));
+
+    for (int i = 0; i < limiter->capacity; i++)
+        limiter->gainHistory[i] = 1.0f;
+
+    limiter->windowLength = limiter->pendingWindowLength;
+    limiter->gainSum = limiter->windowLength;
+    limiter->writeIdx = 0;
+    limiter->dequeFront = 0;
+    limiter->dequeCount = 0;
+    limiter->sampleCount = 0;
+    limiter->gain = 1.0f;
+    limiter->resetPending = 0;
+}
+
+Limiter *limiterCreate(float sampleRate) {
+
+    Limiter *limiter = (Limiter *)calloc(1, sizeof(Limiter));
+
+    limiter->sampleRate = sampleRate;
+    limiter->ceiling = kLimiterDefaultCeiling;
+    limiter->capacity = lookaheadToWindowLength(sampleRate, kLimiterMaxLookahead);
+
+    limiter->delayLine = (float *)calloc(limiter->capacity, sizeof(float));
+    limiter->gainHistory = (float *)calloc(limiter->capacity, sizeof(float));
+    limiter->dequeValues = (float *)calloc(limiter->capacity, sizeof(float));
+    limiter->dequeIndices = (uint32_t *)calloc(limiter->capacity, sizeof(uint32_t));
+
+    limiter->pendingWindowLength = lookaheadToWindowLength(sampleRate, kLimiterDefaultLookahead);
+    limiterSetRelease(limiter, kLimiterDefaultRelease);
+    clearState(limiter);
+
+    return limiter;
+}
+
+void limiterDestroy(Limiter *limiter) {
+
+    if (!limiter)
+        return;
+
+    free(limiter->delayLine);
+    free(limiter->gainHistory);
+    free(limiter->dequeValues);
+    free(limiter->dequeIndices);
+    free(limiter);
+}
+
+void limiterSetLookahead(Limiter *limiter, float milliseconds) {
+
+    limiter->pendingWindowLength = lookaheadToWindowLength(limiter->sampleRate, milliseconds);
+}
+
+void limiterSetRelease(Limiter *limiter, float milliseconds) {
+
+    if (milliseconds < 1.0f)
+        milliseconds = 1.0f;
+
+    limiter->releaseCoeff = 1.0f - expf(-1.0f / (milliseconds * 0.001f * limiter->sampleRate));
+}
+
+void limiterSetCeiling(Limiter *limiter, float ceiling) {
+
+    if (ceiling > 0.0f)
+        limiter->ceiling = ceiling;
+}
+
+int limiterGetLatency(Limiter *limiter) {
+
+    return limiter->pendingWindowLength - 1;
+}
+
+void limiterReset(Limiter *limiter) {
+
+    limiter->resetPending = 1;
+}
+
+void limiterProcess(Limiter *limiter, float *data, int length) {
+
+    if (limiter->resetPending || limiter->pendingWindowLength != limiter->windowLength)
+        clearState(limiter);
+
+    const int window = limiter->windowLength;
+    const int capacity = limiter->capacity;
+    const float ceiling = limiter->ceiling;
+    const float releaseCoeff = limiter->releaseCoeff;
+
+    float *delayLine = limiter->delayLine;
+    float *gainHistory = limiter->gainHistory;
+    float *dequeValues = limiter->dequeValues;
+    uint32_t *dequeIndices = limiter->dequeIndices;
+
+    int writeIdx = limiter->writeIdx;
+    int front = limiter->dequeFront;
+    int count = limiter->dequeCount;
+    uint32_t n = limiter->sampleCount;
+    double gainSum = limiter->gainSum;
+    float gain = limiter->gain;
+
+    for (int i = 0; i < length; i++, n++) {
+
+        float in = data[i];
+        float peak = fabsf(in);
+
+        /* Drop the peak that left the window, then any smaller peaks it dominates */
+        if (count > 0 && n - dequeIndices[front] >= (uint32_t)window) {
+            front = (front + 1 == capacity) ? 0 : front + 1;
+            count--;
+        }
+        while (count > 0) {
+            int back = front + count - 1;
+            if (back >= capacity)
+                back -= capacity;
+            if (dequeValues[back] > peak)
+                break;
+            count--;
+        }
+        int back = front + count;
+        if (back >= capacity)
+            back -= capacity;
+        dequeValues[back] = peak;
+        dequeIndices[back] = n;
+        count++;
+
+        /* Gain required to hold the window peak at the ceiling */
+        float windowPeak = dequeValues[front];
+        float required = (windowPeak > ceiling) ? ceiling / windowPeak : 1.0f;
+
+        /* Box average of the required gain over the window */
+        int expiredIdx = writeIdx - window;
+        if (expiredIdx < 0)
+            expiredIdx += capacity;
+        gainSum += required - gainHistory[expiredIdx];
+        float smoothed = (float)(gainSum / window);
+
+        /* Exponential release, never above the smoothed gain */
+        gain += (1.0f - gain) * releaseCoeff;
+        if (gain > smoothed)
+            gain = smoothed;
+
+        /* Read the sample delayed by the look-ahead before overwriting the slot */
+        int delayedIdx = writeIdx - (window - 1);
+        if (delayedIdx < 0)
+            delayedIdx += capacity;
+        float delayed = delayLine[delayedIdx];
+        gainHistory[writeIdx] = required;
+        delayLine[writeIdx] = in;
+
+        data[i] = delayed * gain;
+
+        writeIdx = (writeIdx + 1 == capacity) ? 0 : writeIdx + 1;
+    }
+
+    limiter->writeIdx = writeIdx;
+    limiter->dequeFront = front;
+    limiter->dequeCount = count;
+    limiter->sampleCount = n;
+    limiter->gainSum = gainSum;
+    limiter->gain = gain;
+}
@@ -0,0 +1,50 @@
+//
+//  Limiter.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Look-ahead brickwall limiter. The window peak is tracked with a monotonic deque (O(1) per sample at any look-ahead) and the gain holding it at the ceiling is box-averaged over the look-ahead, so the gain is down by the time the peak leaves the delay line.
+ */
+
+#ifndef DigitalSoundFX_Limiter_h
+#define DigitalSoundFX_Limiter_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define kLimiterMinLookahead 0.5        // ms
+#define kLimiterMaxLookahead 10.0       // ms
+#define kLimiterDefaultLookahead 1.5    // ms
+#define kLimiterDefaultRelease 50.0     // ms
+#define kLimiterDefaultCeiling 0.98
+
+typedef struct Limiter Limiter;
+
+/* Allocate a limiter with state for the maximum look-ahead (kLimiterMaxLookahead) */
+Limiter *limiterCreate(float sampleRate);
+void limiterDestroy(Limiter *limiter);
+
+/* Set parameters. Look-ahead is clamped to [kLimiterMinLookahead, kLimiterMaxLookahead] and resets the limiter at the start of the next limiterProcess() */
+void limiterSetLookahead(Limiter *limiter, float milliseconds);
+void limiterSetRelease(Limiter *limiter, float milliseconds);
+void limiterSetCeiling(Limiter *limiter, float ceiling);
+
+/* Latency in samples introduced by the look-ahead delay */
+int limiterGetLatency(Limiter *limiter);
+
+/* Clear the delay line and gain state on the next call to limiterProcess() */
+void limiterReset(Limiter *limiter);
+
+/* Limit length samples in place */
+void limiterProcess(Limiter *limiter, float *data, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,354 @@
+//
+//  MultibandDistortion.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/* posix_memalign() under strict C99 */
+#define _POSIX_C_SOURCE 200112L
+
+#include "MultibandDistortion.h"
+#include "Denormals.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_SQRT1_2
+#define M_SQRT1_2 0.70710678118654752440
+#endif
+
+/* One lane per band, padded to a width the compiler splits evenly into NEON/SSE registers */
+#define kMultibandLanes 8
+
+/* Deepest cascade is the top two bands: 2 * (kMultibandMaxBands - 1) LR4 sections */
+#define kMultibandMaxStages (2 * (kMultibandMaxBands - 1))
+
+typedef float LaneVector __attribute__((vector_size(kMultibandLanes * sizeof(float))));
+typedef int32_t LaneMask __attribute__((vector_size(kMultibandLanes * sizeof(int32_t))));
+
+/* Lane-wise mask ? a : b (vector ?: is C++ only) */
+static inline LaneVector laneSelect(LaneMask mask, LaneVector a, LaneVector b) {
+    return (LaneVector)(((LaneMask)a & mask) | ((LaneMask)b & ~mask));
+}
+
+/* Zero lanes below kDenormalThreshold */
+static inline LaneVector flushLanes(LaneVector v) {
+    LaneMask small = (v < kDenormalThreshold) & (v > -kDenormalThreshold);
+    return laneSelect(small, (LaneVector){0}, v);
+}
+
+typedef struct BiquadLanes {
+    LaneVector b0, b1, b2, a1, a2;      // Normalized by a0
+    LaneVector z1, z2;                  // Transposed direct form II state
+} BiquadLanes;
+
+struct MultibandDistortion {
+
+    float sampleRate;
+    int nBands;
+    int nStages;
+    float crossovers[kMultibandMaxBands - 1];
+
+    /* Set from the UI thread and applied at the start of the next multibandProcess() */
+    int pendingBands;
+    float pendingCrossovers[kMultibandMaxBands - 1];
+    int updatePending;          // Bands, crossovers or shapes changed
+    int resetPending;
+
+    BiquadLanes stages[kMultibandMaxStages];
+
+    MultibandShape shapes[kMultibandMaxBands];
+    LaneVector thresholds;      // Relative thresholds, padded lanes 1
+    LaneVector bandMask;        // 1 for active bands, 0 for padding
+    LaneVector softMask;        // 1 where the band uses the soft clipper
+};
+
+typedef enum SectionType {
+    kSectionIdentity,
+    kSectionLowpass,
+    kSectionHighpass,
+    kSectionAllpass
+} SectionType;
+
+/* RBJ cookbook second-order sections with Q = 1/sqrt(2) (Butterworth; two in cascade give LR4) */
+static void sectionCoefficients(SectionType type, double frequency, double sampleRate, double *coeffs) {
+
+    if (type == kSectionIdentity) {
+        coeffs[0] = 1.0;
+        coeffs[1] = coeffs[2] = coeffs[3] = coeffs[4] = 0.0;
+        return;
+    }
+
+    double omega = 2.0 * M_PI * frequency / sampleRate;
+    double cosW = cos(omega);
+    double alpha = sin(omega) / (2.0 * M_SQRT1_2);
+    double a0 = 1.0 + alpha;
+    double b0, b1, b2;
+
+    switch (type) {
+        case kSectionLowpass:
+            b0 = b2 = (1.0 - cosW) / 2.0;
+            b1 = 1.0 - cosW;
+            break;
+        case kSectionHighpass:
+            b0 = b2 = (1.0 + cosW) / 2.0;
+            b1 = -(1.0 + cosW);
+            break;
+        case kSectionAllpass:
+        default:
+            b0 = 1.0 - alpha;
+            b1 = -2.0 * cosW;
+            b2 = 1.0 + alpha;
+            break;
+    }
+
+    coeffs[0] = b0 / a0;
+    coeffs[1] = b1 / a0;
+    coeffs[2] = b2 / a0;
+    coeffs[3] = -2.0 * cosW / a0;
+    coeffs[4] = (1.0 - alpha) / a0;
+}
+
+static void setSection(MultibandDistortion *mb, int stage, int lane, SectionType type, double frequency) {
+
+    double c[5];
+    sectionCoefficients(type, frequency, mb->sampleRate, c);
+
+    mb->stages[stage].b0[lane] = c[0];
+    mb->stages[stage].b1[lane] = c[1];
+    mb->stages[stage].b2[lane] = c[2];
+    mb->stages[stage].a1[lane] = c[3];
+    mb->stages[stage].a2[lane] = c[4];
+}
+
+/* Lay out each band's cascade in its lane: HP(f1..fk), LP(fk+1), AP(fk+2..fN-1), identity padding */
+static void updateCoefficients(MultibandDistortion *mb) {
+
+    int nCrossovers = mb->nBands - 1;
+    int maxDepth = 0;
+
+    for (int lane = 0; lane < kMultibandLanes; lane++) {
+
+        int stage = 0;
+
+        if (lane < mb->nBands) {
+
+            for (int j = 0; j < lane; j++) {
+                setSection(mb, stage++, lane, kSectionHighpass, mb->crossovers[j]);
+                setSection(mb, stage++, lane, kSectionHighpass, mb->crossovers[j]);
+            }
+            if (lane < nCrossovers) {
+                setSection(mb, stage++, lane, kSectionLowpass, mb->crossovers[lane]);
+                setSection(mb, stage++, lane, kSectionLowpass, mb->crossovers[lane]);
+            }
+            for (int j = lane + 1; j < nCrossovers; j++)
+                setSection(mb, stage++, lane, kSectionAllpass, mb->crossovers[j]);
+        }
+
+        if (stage > maxDepth)
+            maxDepth = stage;
+
+        for (; stage < kMultibandMaxStages; stage++)
+            setSection(mb, stage, lane, kSectionIdentity, 0.0);
+    }
+
+    mb->nStages = maxDepth;
+}
+
+static void updateMasks(MultibandDistortion *mb) {
+
+    for (int lane = 0; lane < kMultibandLanes; lane++) {
+        mb->bandMask[lane] = (lane < mb->nBands) ? 1.0f : 0.0f;
+        mb->softMask[lane] = (lane < mb->nBands && mb->shapes[lane] == kMultibandSoftClip) ? 1.0f : 0.0f;
+    }
+}
+
+/* Take on the pending band layout. Called on the render thread (or before it starts) */
+static void applyPending(MultibandDistortion *mb) {
+
+    /* Cleared first so a change made while copying is picked up on the next call */
+    mb->updatePending = 0;
+
+    int nBands = mb->pendingBands;
+    if (nBands != mb->nBands)
+        mb->resetPending = 1;
+
+    mb->nBands = nBands;
+    memcpy(mb->crossovers, mb->pendingCrossovers, sizeof(mb->crossovers));
+
+    updateCoefficients(mb);
+    updateMasks(mb);
+}
+
+static void clearState(MultibandDistortion *mb) {
+
+    mb->resetPending = 0;
+
+    for (int s = 0; s < kMultibandMaxStages; s++) {
+        memset(&mb->stages[s].z1, 0, sizeof(LaneVector));
+        memset(&mb->stages[s].z2, 0, sizeof(LaneVector));
+    }
+}
+
+MultibandDistortion *multibandCreate(float sampleRate) {
+
+    /* Vector members need more alignment than calloc guarantees */
+    void *memory = NULL;
+    if (posix_memalign(&memory, sizeof(LaneVector), sizeof(MultibandDistortion)) != 0)
+        return NULL;
+    memset(memory, 0, sizeof(MultibandDistortion));
+    MultibandDistortion *mb = (MultibandDistortion *)memory;
+
+    mb->sampleRate = sampleRate;
+
+    for (int lane = 0; lane < kMultibandLanes; lane++)
+        mb->thresholds[lane] = 1.0f;
+    for (int band = 0; band < kMultibandMaxBands; band++)
+        mb->shapes[band] = kMultibandHardClip;
+
+    multibandSetNumBands(mb, kMultibandDefaultBands);
+    applyPending(mb);
+    clearState(mb);
+
+    return mb;
+}
+
+void multibandDestroy(MultibandDistortion *mb) {
+
+    free(mb);
+}
+
+void multibandSetNumBands(MultibandDistortion *mb, int nBands) {
+
+    if (nBands < kMultibandMinBands)
+        nBands = kMultibandMinBands;
+    if (nBands > kMultibandMaxBands)
+        nBands = kMultibandMaxBands;
+
+    /* Log-spaced crossovers; a single crossover sits at the geometric mean */
+    int nCrossovers = nBands - 1;
+    for (int i = 0; i < nCrossovers; i++) {
+        float position = (nCrossovers == 1) ? 0.5f : (float)i / (nCrossovers - 1);
+        mb->pendingCrossovers[i] = kMultibandLowestCrossover * powf(kMultibandHighestCrossover / kMultibandLowestCrossover, position);
+    }
+
+    mb->pendingBands = nBands;
+    mb->resetPending = 1;
+    mb->updatePending = 1;
+}
+
+int multibandGetNumBands(MultibandDistortion *mb) {
+
+    return mb->pendingBands;
+}
+
+void multibandSetCrossover(MultibandDistortion *mb, int idx, float frequency) {
+
+    int nBands = mb->pendingBands;
+    if (idx < 0 || idx >= nBands - 1)
+        return;
+
+    float low = (idx > 0) ? mb->pendingCrossovers[idx - 1] : 10.0f;
+    float high = (idx < nBands - 2) ? mb->pendingCrossovers[idx + 1] : 0.49f * mb->sampleRate;
+    if (frequency <= low || frequency >= high)
+        return;
+
+    mb->pendingCrossovers[idx] = frequency;
+    mb->updatePending = 1;
+}
+
+float multibandGetCrossover(MultibandDistortion *mb, int idx) {
+
+    if (idx < 0 || idx >= mb->pendingBands - 1)
+        return 0.0f;
+
+    return mb->pendingCrossovers[idx];
+}
+
+void multibandSetShape(MultibandDistortion *mb, int band, MultibandShape shape) {
+
+    if (band < 0 || band >= kMultibandMaxBands)
+        return;
+
+    mb->shapes[band] = shape;
+    mb->updatePending = 1;
+}
+
+void multibandSetThreshold(MultibandDistortion *mb, int band, float relativeThreshold) {
+
+    if (band < 0 || band >= kMultibandMaxBands || relativeThreshold <= 0.0f)
+        return;
+
+    mb->thresholds[band] = relativeThreshold;
+}
+
+void multibandReset(MultibandDistortion *mb) {
+
+    mb->resetPending = 1;
+}
+
+void multibandProcess(MultibandDistortion *mb, float *data, int length, float clippingAmplitude) {
+
+    if (mb->updatePending)
+        applyPending(mb);
+    if (mb->resetPending)
+        clearState(mb);
+
+    const int nStages = mb->nStages;
+    const LaneVector threshold = mb->thresholds * clippingAmplitude;
+    const LaneVector inverseThreshold = 1.0f / threshold;
+    const LaneVector bandMask = mb->bandMask;
+    const LaneVector softMask = mb->softMask;
+    const LaneVector hardMask = 1.0f - softMask;
+
+    /* Work on a local copy of the state so it stays in registers */
+    BiquadLanes stages[kMultibandMaxStages];
+    memcpy(stages, mb->stages, nStages * sizeof(BiquadLanes));
+
+    for (int i = 0; i < length; i++) {
+
+        LaneVector v = (LaneVector){0} + data[i];
+
+        /* Every band's cascade, one section per step, all lanes at once */
+        for (int s = 0; s < nStages; s++) {
+            BiquadLanes *bq = &stages[s];
+            LaneVector y = bq->b0 * v + bq->z1;
+            bq->z1 = bq->b1 * v - bq->a1 * y + bq->z2;
+            bq->z2 = bq->b2 * v - bq->a2 * y;
+            v = y;
+        }
+
+        /* Hard clip: clamp to +/-threshold */
+        LaneVector hard = laneSelect(v > threshold, threshold, v);
+        hard = laneSelect(hard < -threshold, -threshold, hard);
+
+        /* Soft clip: threshold * x(27 + x^2) / (27 + 9x^2) on x = v/threshold clamped to +/-3 (saturates at threshold) */
+        LaneVector x = v * inverseThreshold;
+        x = laneSelect(x > 3.0f, (LaneVector){0} + 3.0f, x);
+        x = laneSelect(x < -3.0f, (LaneVector){0} - 3.0f, x);
+        LaneVector x2 = x * x;
+        LaneVector soft = threshold * x * (27.0f + x2) / (27.0f + 9.0f * x2);
+
+        LaneVector shaped = (hardMask * hard + softMask * soft) * bandMask;
+
+        float sum = 0.0f;
+        for (int lane = 0; lane < kMultibandLanes; lane++)
+            sum += shaped[lane];
+        data[i] = sum;
+    }
+
+    /* Keep the filter state out of the subnormal range once the input goes quiet */
+    for (int s = 0; s < nStages; s++) {
+        stages[s].z1 = flushLanes(stages[s].z1);
+        stages[s].z2 = flushLanes(stages[s].z2);
+    }
+
+    memcpy(mb->stages, stages, nStages * sizeof(BiquadLanes));
+}
@@ -0,0 +1,60 @@
+//
+//  MultibandDistortion.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Multiband distortion: a Linkwitz-Riley (LR4) crossover splits the signal into 2-5 bands, each band is clipped with its own waveshaper and threshold, and the bands are summed back together. Unclipped, the bands sum to an allpass (flat magnitude). The bands are filtered together in the lanes of one SIMD vector.
+ */
+
+#ifndef DigitalSoundFX_MultibandDistortion_h
+#define DigitalSoundFX_MultibandDistortion_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define kMultibandMinBands 2
+#define kMultibandMaxBands 5
+#define kMultibandDefaultBands 3
+#define kMultibandLowestCrossover 150.0     // Default crossovers are log-spaced between these (Hz)
+#define kMultibandHighestCrossover 6000.0
+
+typedef enum MultibandShape {
+    kMultibandHardClip,     // Same as the full-band clipper
+    kMultibandSoftClip      // Rational tanh approximation saturating at the threshold
+} MultibandShape;
+
+typedef struct MultibandDistortion MultibandDistortion;
+
+MultibandDistortion *multibandCreate(float sampleRate);
+void multibandDestroy(MultibandDistortion *mb);
+
+/* Band count and crossover changes take effect at the start of the next multibandProcess() */
+
+/* Set the number of bands in [kMultibandMinBands, kMultibandMaxBands] with default log-spaced crossovers. Clears the filter state */
+void multibandSetNumBands(MultibandDistortion *mb, int nBands);
+int multibandGetNumBands(MultibandDistortion *mb);
+
+/* Set the crossover frequency between bands idx and idx+1. Crossovers must remain in increasing order */
+void multibandSetCrossover(MultibandDistortion *mb, int idx, float frequency);
+float multibandGetCrossover(MultibandDistortion *mb, int idx);
+
+/* Per-band waveshaper and threshold (relative to the clipping amplitude passed to multibandProcess) */
+void multibandSetShape(MultibandDistortion *mb, int band, MultibandShape shape);
+void multibandSetThreshold(MultibandDistortion *mb, int band, float relativeThreshold);
+
+/* Clear the filter state on the next call to multibandProcess() */
+void multibandReset(MultibandDistortion *mb);
+
+/* Split, clip and recombine length samples in place. Band thresholds are scaled by clippingAmplitude */
+void multibandProcess(MultibandDistortion *mb, float *data, int length, float clippingAmplitude);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
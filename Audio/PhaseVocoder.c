@@ -0,0 +1,504 @@
+//
+//  PhaseVocoder.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+#include "PhaseVocoder.h"
+#include "FFT.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Positive spectral flux (fraction of total magnitude) above which a frame is treated as a transient */
+#define kTransientFluxThreshold 0.4f
+
+/* Slack in the resampler and output buffers for the cubic interpolator's neighbouring samples */
+#define kResampleTaps 4
+
+struct PhaseVocoder {
+
+    int fftSize;
+    int hop;
+    int nBins;
+
+    FFTPlan *plan;
+    float *window;
+    float olaScale;             // Normalizes the summed analysis * synthesis windows to 1
+
+    float pitchRatio;
+    int transientPreserving;
+    int resetPhases;
+
+    /* Spectral buffers, length nBins. Phases are measured from the frame center. real/imag hold magnitude/phase in between transforms */
+    float *real;
+    float *imag;
+    float *trueFreq;            // Estimated frequency of each bin (radians/sample)
+    float *lastPhase;           // Analysis phase of the previous frame
+    float *synthPhase;          // Synthesis phase of the previous frame
+    float *prevMag;             // Magnitude of the previous frame, for spectral flux
+    float *outReal;             // Phase-locked spectrum
+    float *outImag;
+    int *peaks;                 // Spectral peaks of the current frame
+
+    /* Time-domain buffers */
+    float *frame;               // Length fftSize
+    float *inRing;              // Length fftSize, most recent input
+    int inPos;
+    float *outRing;             // Length fftSize, overlap-add accumulator
+    int outPos;
+
+    /* Streaming pitch shift: analysis frames every hop / ratio input samples are stretched to one hop each, then resampled by ratio */
+    float frameRatio;           // Ratio for the frames in flight, taken from pitchRatio once per frame
+    double untilFrame;          // Input samples until the next analysis frame
+    int sinceFrame;             // Input samples since the last analysis frame
+    float *stretched;           // Stretched samples awaiting resampling, length hop + kResampleTaps
+    int stretchedCount;
+    double readPos;             // Resampler position in stretched
+    float *outFifo;             // Ring of finished output, length fifoCapacity
+    int fifoCapacity;
+    int fifoRead;
+    int fifoCount;
+    int fifoLatency;            // Samples kept queued: one analysis hop for the current ratio, see fifoLatencyForRatio()
+};
+
+/* Output FIFO depth for a pitch ratio: it has to last from one analysis frame to the next, hop / ratio input samples later. Rounded up to hop times a power of two so the depth only changes when the ratio crosses an octave below 1 */
+static int fifoLatencyForRatio(int hop, float ratio) {
+
+    int latency = hop;
+    while (latency * ratio < hop)
+        latency *= 2;
+
+    return latency + kResampleTaps;
+}
+
+static inline float wrapPhase(float phase) {
+
+    return phase - 2.0f * (float)M_PI * floorf(phase / (2.0f * (float)M_PI) + 0.5f);
+}
+
+PhaseVocoder *phaseVocoderCreate(int fftSize, int overlap) {
+
+    if (overlap < 4 || (overlap & (overlap - 1)) || overlap >= fftSize)
+        return NULL;
+
+    FFTPlan *plan = fftPlanCreate(fftSize);
+    if (!plan)
+        return NULL;
+
+    PhaseVocoder *pv = (PhaseVocoder *)calloc(1, sizeof(PhaseVocoder));
+
+    pv->fftSize = fftSize;
+    pv->hop = fftSize / overlap;
+    pv->nBins = fftSize / 2 + 1;
+    pv->plan = plan;
+    pv->pitchRatio = 1.0f;
+
+    /* Periodic Hann window */
+    pv->window = (float *)malloc(fftSize * sizeof(float));
+    for (int n = 0; n < fftSize; n++)
+        pv->window[n] = 0.5 - 0.5 * cos(2.0 * M_PI * n / fftSize);
+
+    /* Sum of squared windows at hop spacing is constant for overlap >= 4 */
+    double windowSum = 0.0;
+    for (int n = 0; n < fftSize; n += pv->hop)
+        windowSum += pv->window[n] * pv->window[n];
+    pv->olaScale = 1.0 / windowSum;
+
+    float **spectral[] = { &pv->real, &pv->imag, &pv->trueFreq, &pv->lastPhase, &pv->synthPhase,
+                           &pv->prevMag, &pv->outReal, &pv->outImag };
+    for (int i = 0; i < (int)(sizeof(spectral) / sizeof(spectral[0])); i++)
+        *spectral[i] = (float *)calloc(pv->nBins, sizeof(float));
+    pv->peaks = (int *)calloc(pv->nBins, sizeof(int));
+
+    pv->frame = (float *)calloc(fftSize, sizeof(float));
+    pv->inRing = (float *)calloc(fftSize, sizeof(float));
+    pv->outRing = (float *)calloc(fftSize, sizeof(float));
+    pv->stretched = (float *)calloc(pv->hop + kResampleTaps, sizeof(float));
+
+    /* Allocated for the lowest ratio, where an analysis frame comes every hop / kPhaseVocoderMinPitchRatio samples */
+    pv->fifoCapacity = 2 * fifoLatencyForRatio(pv->hop, kPhaseVocoderMinPitchRatio) + kResampleTaps;
+    pv->outFifo = (float *)calloc(pv->fifoCapacity, sizeof(float));
+
+    phaseVocoderReset(pv);
+
+    return pv;
+}
+
+void phaseVocoderDestroy(PhaseVocoder *pv) {
+
+    if (!pv)
+        return;
+
+    fftPlanDestroy(pv->plan);
+    free(pv->window);
+    free(pv->real);
+    free(pv->imag);
+    free(pv->trueFreq);
+    free(pv->lastPhase);
+    free(pv->synthPhase);
+    free(pv->prevMag);
+    free(pv->outReal);
+    free(pv->outImag);
+    free(pv->peaks);
+    free(pv->frame);
+    free(pv->inRing);
+    free(pv->outRing);
+    free(pv->stretched);
+    free(pv->outFifo);
+    free(pv);
+}
+
+void phaseVocoderSetPitchRatio(PhaseVocoder *pv, float ratio) {
+
+    if (ratio < kPhaseVocoderMinPitchRatio)
+        ratio = kPhaseVocoderMinPitchRatio;
+    if (ratio > kPhaseVocoderMaxPitchRatio)
+        ratio = kPhaseVocoderMaxPitchRatio;
+
+    pv->pitchRatio = ratio;
+}
+
+void phaseVocoderSetTransientPreserving(PhaseVocoder *pv, int enabled) {
+
+    pv->transientPreserving = enabled;
+}
+
+int phaseVocoderGetLatency(PhaseVocoder *pv) {
+
+    /* Frame and overlap-add, then the FIFO */
+    return pv->fftSize - pv->hop + fifoLatencyForRatio(pv->hop, pv->pitchRatio);
+}
+
+void phaseVocoderReset(PhaseVocoder *pv) {
+
+    memset(pv->lastPhase, 0, pv->nBins * sizeof(float));
+    memset(pv->synthPhase, 0, pv->nBins * sizeof(float));
+    memset(pv->prevMag, 0, pv->nBins * sizeof(float));
+    memset(pv->inRing, 0, pv->fftSize * sizeof(float));
+    memset(pv->outRing, 0, pv->fftSize * sizeof(float));
+    memset(pv->outFifo, 0, pv->fifoCapacity * sizeof(float));
+    pv->inPos = 0;
+    pv->outPos = 0;
+    pv->resetPhases = 1;
+
+    pv->frameRatio = pv->pitchRatio;
+    pv->untilFrame = pv->hop;
+    pv->sinceFrame = 0;
+
+    /* One sample of history behind the read position */
+    memset(pv->stretched, 0, (pv->hop + kResampleTaps) * sizeof(float));
+    pv->stretchedCount = 1;
+    pv->readPos = 1.0;
+
+    pv->fifoLatency = fifoLatencyForRatio(pv->hop, pv->frameRatio);
+    pv->fifoRead = 0;
+    pv->fifoCount = pv->fifoLatency;
+}
+
+/* Local maxima of the magnitude over two bins either side. Returns the number found */
+static int findPeaks(const float *mag, int nBins, int *peaks) {
+
+    int nPeaks = 0;
+
+    for (int k = 0; k < nBins; k++) {
+
+        float m = mag[k];
+        if (m <= 0.0f)
+            continue;
+        if ((k >= 1 && mag[k - 1] >= m) || (k >= 2 && mag[k - 2] >= m))
+            continue;
+        if ((k + 1 < nBins && mag[k + 1] > m) || (k + 2 < nBins && mag[k + 2] > m))
+            continue;
+
+        peaks[nPeaks++] = k;
+    }
+
+    return nPeaks;
+}
+
+/* Analyze pv->frame (fftSize unwindowed samples), modify, and resynthesize into pv->frame (windowed, ready to overlap-add). Bins at and above cutoffBin are dropped.
+
+   Identity phase locking (Laroche & Dolson): only spectral peaks get their phase advanced by the estimated frequency. Every other bin in a peak's region (up to the magnitude minimum between neighbouring peaks) keeps its analysis phase offset from the peak. The bins making up one sinusoid then stay coherent, instead of each drifting on its own frequency estimate and partially cancelling when the hops differ */
+static void processFrame(PhaseVocoder *pv, int analysisHop, int synthesisHop, int cutoffBin) {
+
+    const int N = pv->fftSize;
+    const int nBins = pv->nBins;
+    float *real = pv->real;
+    float *imag = pv->imag;
+    float *outReal = pv->outReal;
+    float *outImag = pv->outImag;
+
+    for (int n = 0; n < N; n++)
+        pv->frame[n] *= pv->window[n];
+
+    fftForwardReal(pv->plan, pv->frame, real, imag);
+
+    /* Magnitude/phase, true frequency from the phase advance, and positive spectral flux. Negating odd bins measures phase from the frame center, where the bins of a windowed sinusoid share a phase */
+    float binFreq = 2.0f * (float)M_PI / N;
+    float flux = 0.0f, total = 0.0f;
+
+    for (int k = 0; k < nBins; k++) {
+
+        float sign = (k & 1) ? -1.0f : 1.0f;
+        float mag = sqrtf(real[k] * real[k] + imag[k] * imag[k]);
+        float phase = atan2f(sign * imag[k], sign * real[k]);
+
+        float deviation = wrapPhase(phase - pv->lastPhase[k] - binFreq * k * analysisHop);
+        pv->trueFreq[k] = binFreq * k + deviation / analysisHop;
+        pv->lastPhase[k] = phase;
+
+        float rise = mag - pv->prevMag[k];
+        flux += (rise > 0.0f) ? rise : 0.0f;
+        total += mag;
+        pv->prevMag[k] = mag;
+
+        real[k] = mag;
+        imag[k] = phase;
+    }
+
+    int transient = pv->resetPhases ||
+                    (pv->transientPreserving && flux > kTransientFluxThreshold * (total + 1e-9f));
+    pv->resetPhases = 0;
+
+    const float *mag = real, *phase = imag;
+    int *peaks = pv->peaks;
+    int nPeaks = findPeaks(mag, nBins, peaks);
+
+    memset(outReal, 0, nBins * sizeof(float));
+    memset(outImag, 0, nBins * sizeof(float));
+
+    int regionStart = 0;
+
+    for (int i = 0; i < nPeaks; i++) {
+
+        int peak = peaks[i];
+
+        /* Region ends at the quietest bin before the next peak */
+        int regionEnd = nBins - 1;
+        if (i + 1 < nPeaks) {
+            regionEnd = peak;
+            for (int k = peak + 1; k < peaks[i + 1]; k++)
+                if (mag[k] < mag[regionEnd])
+                    regionEnd = k;
+        }
+
+        /* Advance the peak (or restart it from the analysis phase on a transient) and lock its region to it */
+        float peakPhase = transient ? phase[peak] :
+                          wrapPhase(pv->synthPhase[peak] + pv->trueFreq[peak] * synthesisHop);
+
+        for (int k = regionStart; k <= regionEnd; k++) {
+
+            float locked = peakPhase + phase[k] - phase[peak];
+            pv->synthPhase[k] = locked;
+
+            if (k < cutoffBin) {
+                outReal[k] = mag[k] * cosf(locked);
+                outImag[k] = mag[k] * sinf(locked);
+            }
+        }
+
+        regionStart = regionEnd + 1;
+    }
+
+    /* Back to phase from the frame start. DC and Nyquist are real for a real signal */
+    for (int k = 1; k < nBins; k += 2) {
+        outReal[k] = -outReal[k];
+        outImag[k] = -outImag[k];
+    }
+    outImag[0] = 0.0f;
+    outImag[nBins - 1] = 0.0f;
+
+    fftInverseReal(pv->plan, outReal, outImag, pv->frame);
+
+    for (int n = 0; n < N; n++)
+        pv->frame[n] *= pv->window[n] * pv->olaScale;
+}
+
+/* Cubic (Catmull-Rom) interpolation between x[1] and x[2] */
+static inline float interpolate(const float *x, float t) {
+
+    float a = x[3] - x[0] + 3.0f * (x[1] - x[2]);
+    float b = 2.0f * x[0] - 5.0f * x[1] + 4.0f * x[2] - x[3];
+    float c = x[2] - x[0];
+
+    return x[1] + 0.5f * t * (c + t * (b + t * a));
+}
+
+/* Change the FIFO depth when the ratio moves to another octave: queue silence ahead of the pending output to deepen it, or drop the oldest pending samples to shorten it */
+static void fifoResize(PhaseVocoder *pv, int latency) {
+
+    int change = latency - pv->fifoLatency;
+    pv->fifoLatency = latency;
+
+    if (change < 0) {
+        int drop = (-change < pv->fifoCount) ? -change : pv->fifoCount;
+        pv->fifoRead = (pv->fifoRead + drop) % pv->fifoCapacity;
+        pv->fifoCount -= drop;
+    }
+
+    for (; change > 0 && pv->fifoCount < pv->fifoCapacity; change--) {
+        pv->fifoRead = (pv->fifoRead == 0) ? pv->fifoCapacity - 1 : pv->fifoRead - 1;
+        pv->outFifo[pv->fifoRead] = 0.0f;
+        pv->fifoCount++;
+    }
+}
+
+static inline void fifoPush(PhaseVocoder *pv, float sample) {
+
+    if (pv->fifoCount == pv->fifoCapacity)
+        return;
+
+    int idx = pv->fifoRead + pv->fifoCount;
+    if (idx >= pv->fifoCapacity)
+        idx -= pv->fifoCapacity;
+
+    pv->outFifo[idx] = sample;
+    pv->fifoCount++;
+}
+
+/* Analyze the most recent fftSize input samples, stretch them to one hop and resample that hop into the output FIFO */
+static void processHop(PhaseVocoder *pv) {
+
+    const int N = pv->fftSize;
+    const int hop = pv->hop;
+    const float ratio = pv->frameRatio;
+
+    /* Unwrap the input ring (oldest first) into the frame */
+    int tail = N - pv->inPos;
+    memcpy(pv->frame, pv->inRing + pv->inPos, tail * sizeof(float));
+    memcpy(pv->frame + tail, pv->inRing, pv->inPos * sizeof(float));
+
+    /* Raising the pitch reads the stretched signal faster; drop what would alias */
+    int cutoffBin = (ratio > 1.0f) ? (int)(pv->nBins / ratio) : pv->nBins;
+
+    processFrame(pv, pv->sinceFrame > 0 ? pv->sinceFrame : hop, hop, cutoffBin);
+
+    /* Overlap-add into the ring accumulator */
+    tail = N - pv->outPos;
+    for (int n = 0; n < tail; n++)
+        pv->outRing[pv->outPos + n] += pv->frame[n];
+    for (int n = tail; n < N; n++)
+        pv->outRing[n - tail] += pv->frame[n];
+
+    /* The oldest hop is now complete: hand it to the resampler and clear its slots */
+    for (int n = 0; n < hop; n++) {
+        pv->stretched[pv->stretchedCount++] = pv->outRing[pv->outPos];
+        pv->outRing[pv->outPos] = 0.0f;
+        if (++pv->outPos == N)
+            pv->outPos = 0;
+    }
+
+    /* Read the stretched signal at ratio samples per output sample, with two samples of look-ahead */
+    while ((int)pv->readPos + 2 < pv->stretchedCount) {
+        int idx = (int)pv->readPos;
+        fifoPush(pv, interpolate(pv->stretched + idx - 1, (float)(pv->readPos - idx)));
+        pv->readPos += ratio;
+    }
+
+    /* Keep one sample behind the read position */
+    int consumed = (int)pv->readPos - 1;
+    if (consumed > pv->stretchedCount)
+        consumed = pv->stretchedCount;
+    memmove(pv->stretched, pv->stretched + consumed, (pv->stretchedCount - consumed) * sizeof(float));
+    pv->stretchedCount -= consumed;
+    pv->readPos -= consumed;
+}
+
+void phaseVocoderProcess(PhaseVocoder *pv, float *data, int length) {
+
+    const int N = pv->fftSize;
+
+    for (int i = 0; i < length; i++) {
+
+        pv->inRing[pv->inPos] = data[i];
+        if (++pv->inPos == N)
+            pv->inPos = 0;
+        pv->sinceFrame++;
+
+        if (pv->fifoCount > 0) {
+            data[i] = pv->outFifo[pv->fifoRead];
+            if (++pv->fifoRead == pv->fifoCapacity)
+                pv->fifoRead = 0;
+            pv->fifoCount--;
+        }
+        else
+            data[i] = 0.0f;
+
+        if (--pv->untilFrame > 0.5)
+            continue;
+
+        processHop(pv);
+
+        /* Frames are one hop apart in the stretched signal, so hop / ratio apart in the input */
+        pv->sinceFrame = 0;
+        pv->frameRatio = pv->pitchRatio;
+        pv->untilFrame += pv->hop / pv->frameRatio;
+
+        int latency = fifoLatencyForRatio(pv->hop, pv->frameRatio);
+        if (latency != pv->fifoLatency)
+            fifoResize(pv, latency);
+    }
+}
+
+int phaseVocoderTimeStretch(const float *in, int inLength, float *out, int outCapacity,
+                            float stretch, int fftSize, int overlap, int preserveTransients) {
+
+    if (stretch <= 0.0f)
+        return 0;
+
+    PhaseVocoder *pv = phaseVocoderCreate(fftSize, overlap);
+    if (!pv)
+        return 0;
+
+    phaseVocoderSetTransientPreserving(pv, preserveTransients);
+
+    int outLength = (int)(inLength * stretch + 0.5f);
+    if (outLength > outCapacity)
+        outLength = outCapacity;
+    memset(out, 0, outLength * sizeof(float));
+
+    const int N = fftSize;
+    const int synthesisHop = pv->hop;
+    const double analysisHop = synthesisHop / (double)stretch;
+
+    /* Start frames before zero so the first samples get full overlap */
+    const int pad = N - synthesisHop;
+    int previousStart = 0;
+
+    for (int m = 0; ; m++) {
+
+        int analysisStart = (int)floor(m * analysisHop + 0.5) - pad;
+        int synthesisStart = m * synthesisHop - pad;
+
+        if (analysisStart >= inLength || synthesisStart >= outLength)
+            break;
+
+        for (int n = 0; n < N; n++) {
+            int idx = analysisStart + n;
+            pv->frame[n] = (idx >= 0 && idx < inLength) ? in[idx] : 0.0f;
+        }
+
+        int hop = (m == 0) ? synthesisHop : analysisStart - previousStart;
+        previousStart = analysisStart;
+
+        processFrame(pv, hop > 0 ? hop : 1, synthesisHop, pv->nBins);
+
+        for (int n = 0; n < N; n++) {
+            int idx = synthesisStart + n;
+            if (idx >= 0 && idx < outLength)
+                out[idx] += pv->frame[n];
+        }
+    }
+
+    phaseVocoderDestroy(pv);
+
+    return outLength;
+}
@@ -0,0 +1,52 @@
+//
+//  PhaseVocoder.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    STFT phase vocoder with identity phase locking, for real-time pitch shifting (a time-stretch resampled by the pitch ratio) and offline time-stretching.
+ */
+
+#ifndef DigitalSoundFX_PhaseVocoder_h
+#define DigitalSoundFX_PhaseVocoder_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define kPhaseVocoderDefaultFFTSize 2048
+#define kPhaseVocoderDefaultOverlap 4
+#define kPhaseVocoderMinPitchRatio 0.25
+#define kPhaseVocoderMaxPitchRatio 4.0
+
+typedef struct PhaseVocoder PhaseVocoder;
+
+/* fftSize must be a power of two, overlap a power of two >= 4 and < fftSize. Returns NULL otherwise */
+PhaseVocoder *phaseVocoderCreate(int fftSize, int overlap);
+void phaseVocoderDestroy(PhaseVocoder *pv);
+
+/* Pitch ratio (2.0 = up an octave), clamped to [kPhaseVocoderMinPitchRatio, kPhaseVocoderMaxPitchRatio] */
+void phaseVocoderSetPitchRatio(PhaseVocoder *pv, float ratio);
+void phaseVocoderSetTransientPreserving(PhaseVocoder *pv, int enabled);
+
+/* Latency in samples of the streaming pitch shifter at the current ratio: fftSize - hop, plus an output FIFO of one analysis hop (hop / ratio rounded up to hop times a power of two, plus a few samples). Lowest for ratios >= 1. Moving the ratio to another octave below 1 changes the latency, inserting or skipping that difference in the output */
+int phaseVocoderGetLatency(PhaseVocoder *pv);
+
+/* Clear the input, phase and overlap-add state */
+void phaseVocoderReset(PhaseVocoder *pv);
+
+/* Pitch shift length samples in place (real-time safe) */
+void phaseVocoderProcess(PhaseVocoder *pv, float *data, int length);
+
+/* Offline time-stretch (stretch > 1 is slower) without changing pitch. Writes at most outCapacity samples to out and returns the number written. Output length is about inLength * stretch */
+int phaseVocoderTimeStretch(const float *in, int inLength, float *out, int outCapacity,
+                            float stretch, int fftSize, int overlap, int preserveTransients);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+//
+//  BenchUtil.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Timing and hardware counter helpers for the Linux benchmarks. Include before any system header.
+
+    Cache counters use perf_event_open(), which containers and kernels with perf_event_paranoid > 2 often refuse. benchCountersOpen() returns 0 in that case and the benchmarks report the miss rate as unavailable rather than failing.
+ */
+
+#ifndef DigitalSoundFX_BenchUtil_h
+#define DigitalSoundFX_BenchUtil_h
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* Seconds on a monotonic clock */
+static inline double benchNow(void) {
+
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/* 1 if --check was passed: short runs with pass/fail checks instead of full measurements */
+static inline int benchCheckMode(int argc, char **argv) {
+
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--check") == 0)
+            return 1;
+
+    return 0;
+}
+
+/* Repeatable uniform noise in [-1, 1] */
+static inline void benchNoise(float *data, int length, uint32_t seed) {
+
+    for (int i = 0; i < length; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = (seed >> 8) / (float)(1 << 23) - 1.0f;
+    }
+}
+
+/* == Cache Counters == */
+
+typedef struct BenchCounters {
+    int references;             // perf event fds, -1 if unavailable
+    int misses;
+} BenchCounters;
+
+static inline int benchOpenCounter(uint64_t config, int group) {
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (group == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+/* Open cache reference/miss counters for this thread. Returns 0 if they're unavailable */
+static inline int benchCountersOpen(BenchCounters *counters) {
+
+    counters->references = benchOpenCounter(PERF_COUNT_HW_CACHE_REFERENCES, -1);
+    counters->misses = (counters->references >= 0) ? benchOpenCounter(PERF_COUNT_HW_CACHE_MISSES, counters->references) : -1;
+
+    if (counters->misses < 0) {
+        if (counters->references >= 0)
+            close(counters->references);
+        counters->references = -1;
+        return 0;
+    }
+
+    return 1;
+}
+
+static inline void benchCountersClose(BenchCounters *counters) {
+
+    if (counters->references < 0)
+        return;
+
+    close(counters->misses);
+    close(counters->references);
+}
+
+static inline void benchCountersStart(BenchCounters *counters) {
+
+    if (counters->references < 0)
+        return;
+
+    ioctl(counters->references, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->references, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/* Misses per reference since benchCountersStart(), or -1 if unavailable */
+static inline double benchCountersStop(BenchCounters *counters) {
+
+    if (counters->references < 0)
+        return -1.0;
+
+    ioctl(counters->references, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    uint64_t references = 0, misses = 0;
+    if (read(counters->references, &references, sizeof(references)) != sizeof(references) ||
+        read(counters->misses, &misses, sizeof(misses)) != sizeof(misses) || references == 0)
+        return -1.0;
+
+    return (double)misses / references;
+}
+
+#endif
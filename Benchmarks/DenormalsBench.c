@@ -0,0 +1,183 @@
+//
+//  DenormalsBench.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Per-block cost of the render chain's recursive filters after an impulse followed by minutes of silence, the input that drives their state into the subnormal range. Each block runs a biquad and multibandProcess(), timed separately:
+
+        biquad:     the recurrence vDSP_deq22 computes, on NVDSP-style keep buffers (NVDSP's 20 Hz, Q = 2 highpass). A model of NVDSP's filter, since vDSP isn't available off Apple
+        multiband:  the shipped MultibandDistortion. It always flushes its crossover lanes after each block, but that doesn't cover its input: unprotected, it's fed the biquad's subnormal tail
+
+    with each combination of the protections the render callback uses:
+
+        none:       no flushing of the biquad keep buffers and no FTZ/DAZ (only the multiband's own lane flush)
+        flush:      flushDenormals() on the biquad keep buffers after each block, as NVDSP does
+        FTZ/DAZ:    denormalsDisable()/denormalsRestore() around the block, as the render callback does
+        both:       what the app runs
+
+    --check fails if a protected configuration's late blocks (the last kLateBlocks) cost more than kSlowdownLimit times its early blocks, for either stage. The unprotected run is reported for comparison only, since hardware that flushes by default never slows down.
+ */
+
+#include "BenchUtil.h"
+#include "Denormals.h"
+#include "MultibandDistortion.h"
+
+#include <math.h>
+
+#define kSampleRate 44100.0
+#define kBlockSize 1024
+#define kEarlyBlocks 32         // Measured after the first block, while the state is still normal
+#define kLateBlocks 256
+#define kSlowdownLimit 3.0
+
+enum { kProtectFlush = 1, kProtectFTZ = 2 };
+
+/* y[n] = c0 x[n] + c1 x[n-1] + c2 x[n-2] - c3 y[n-1] - c4 y[n-2], with two samples of history at the start of x and y */
+static void deq22(const float *x, float *y, const float *c, int length) {
+
+    for (int n = 2; n < length + 2; n++)
+        y[n] = c[0] * x[n] + c[1] * x[n - 1] + c[2] * x[n - 2] - c[3] * y[n - 1] - c[4] * y[n - 2];
+}
+
+/* RBJ highpass, as NVHighpassFilter computes it */
+static void highpassCoefficients(double frequency, double Q, float *c) {
+
+    double omega = 2.0 * 3.14159265358979323846 * frequency / kSampleRate;
+    double alpha = sin(omega) / (2.0 * Q);
+    double cosW = cos(omega);
+    double a0 = 1.0 + alpha;
+
+    c[0] = (1.0 + cosW) / 2.0 / a0;
+    c[1] = -(1.0 + cosW) / a0;
+    c[2] = (1.0 + cosW) / 2.0 / a0;
+    c[3] = -2.0 * cosW / a0;
+    c[4] = (1.0 - alpha) / a0;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *values, int count) {
+
+    qsort(values, count, sizeof(double), compareDoubles);
+    return values[count / 2];
+}
+
+typedef struct StageCost {
+    double early;               // Median block cost, us
+    double late;
+} StageCost;
+
+static StageCost stageCost(double *times, int nBlocks) {
+
+    StageCost cost;
+    cost.early = median(times + 1, kEarlyBlocks);
+    cost.late = median(times + nBlocks - kLateBlocks, kLateBlocks);
+    return cost;
+}
+
+/* Early and late block costs of each stage, and the number of blocks that ended with subnormal biquad state */
+static void run(int protection, int nBlocks, StageCost *biquad, StageCost *multiband, int *subnormalBlocks) {
+
+    float c[5];
+    highpassCoefficients(20.0, 2.0, c);
+
+    float x[kBlockSize + 2], y[kBlockSize + 2], data[kBlockSize];
+    float keepIn[2] = { 0.0f, 0.0f }, keepOut[2] = { 0.0f, 0.0f };
+
+    MultibandDistortion *mb = multibandCreate(kSampleRate);
+
+    double *biquadTimes = (double *)malloc(nBlocks * sizeof(double));
+    double *multibandTimes = (double *)malloc(nBlocks * sizeof(double));
+    *subnormalBlocks = 0;
+
+    for (int b = 0; b < nBlocks; b++) {
+
+        memset(data, 0, sizeof(data));
+        if (b == 0)
+            data[0] = 1.0f;
+
+        DenormalMode mode = 0;
+        if (protection & kProtectFTZ)
+            mode = denormalsDisable();
+
+        double start = benchNow();
+
+        memcpy(x, keepIn, sizeof(keepIn));
+        memcpy(y, keepOut, sizeof(keepOut));
+        memcpy(x + 2, data, sizeof(data));
+        deq22(x, y, c, kBlockSize);
+        memcpy(data, y + 2, sizeof(data));
+        memcpy(keepIn, x + kBlockSize, sizeof(keepIn));
+        memcpy(keepOut, y + kBlockSize, sizeof(keepOut));
+
+        if (protection & kProtectFlush) {
+            flushDenormals(keepIn, 2);
+            flushDenormals(keepOut, 2);
+        }
+
+        double split = benchNow();
+        multibandProcess(mb, data, kBlockSize, 1.0f);
+        double end = benchNow();
+
+        if (protection & kProtectFTZ)
+            denormalsRestore(mode);
+
+        biquadTimes[b] = 1e6 * (split - start);
+        multibandTimes[b] = 1e6 * (end - split);
+
+        if (fpclassify(keepOut[0]) == FP_SUBNORMAL || fpclassify(keepOut[1]) == FP_SUBNORMAL)
+            (*subnormalBlocks)++;
+    }
+
+    *biquad = stageCost(biquadTimes, nBlocks);
+    *multiband = stageCost(multibandTimes, nBlocks);
+
+    free(biquadTimes);
+    free(multibandTimes);
+    multibandDestroy(mb);
+}
+
+int main(int argc, char **argv) {
+
+    int check = benchCheckMode(argc, argv);
+    int seconds = check ? 60 : 180;
+    int nBlocks = (int)(seconds * kSampleRate / kBlockSize);
+    int failed = 0;
+
+    const char *names[] = { "none", "flush", "FTZ/DAZ", "both" };
+
+    printf("Impulse then %d s of silence, %d-sample blocks. Median block cost (us), early / late\n", seconds, kBlockSize);
+    printf("%-10s %22s %22s %18s\n", "protection", "biquad (deq22 model)", "multiband (shipped)", "subnormal blocks");
+
+    for (int protection = 0; protection < 4; protection++) {
+
+        StageCost biquad, multiband;
+        int subnormalBlocks;
+        run(protection, nBlocks, &biquad, &multiband, &subnormalBlocks);
+
+        printf("%-10s %7.1f / %7.1f %5.1fx %7.1f / %7.1f %5.1fx %18d\n", names[protection],
+               biquad.early, biquad.late, biquad.late / biquad.early,
+               multiband.early, multiband.late, multiband.late / multiband.early, subnormalBlocks);
+
+        if (check && protection != 0 && biquad.late > kSlowdownLimit * biquad.early) {
+            printf("FAIL: %s biquad late blocks cost %.1fx early blocks (limit %.0fx)\n", names[protection],
+                   biquad.late / biquad.early, kSlowdownLimit);
+            failed = 1;
+        }
+        if (check && protection != 0 && multiband.late > kSlowdownLimit * multiband.early) {
+            printf("FAIL: %s multiband late blocks cost %.1fx early blocks (limit %.0fx)\n", names[protection],
+                   multiband.late / multiband.early, kSlowdownLimit);
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,133 @@
+//
+//  LimiterBench.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Limiter cost per sample against look-ahead length. The peak deque and running gain average are O(1) amortised per sample, so the cost should stay flat from kLimiterMinLookahead to kLimiterMaxLookahead.
+
+    --check fails if the output exceeds the ceiling, if a signal below the ceiling isn't passed through unchanged (after the latency), or if the longest look-ahead costs more than 3x the shortest.
+ */
+
+#include "BenchUtil.h"
+#include "Limiter.h"
+
+#include <math.h>
+
+#define kSampleRate 44100.0f
+#define kBlockSize 1024
+#define kRepeats 5
+
+/* Loud tone with bursts and isolated spikes, well over the ceiling */
+static void makeProgram(float *data, int length) {
+
+    benchNoise(data, length, 7);
+
+    for (int i = 0; i < length; i++) {
+        float level = ((i / 5000) % 2) ? 3.0f : 0.6f;
+        data[i] = level * sinf(0.05f * i) + 0.1f * data[i];
+        if (i % 997 == 0)
+            data[i] += 5.0f;
+    }
+}
+
+/* Median seconds to limit the program in render-callback blocks */
+static double timeLimiter(Limiter *limiter, const float *program, float *scratch, int length) {
+
+    double times[kRepeats];
+
+    for (int r = 0; r < kRepeats; r++) {
+
+        memcpy(scratch, program, length * sizeof(float));
+        limiterReset(limiter);
+
+        double start = benchNow();
+        for (int i = 0; i < length; i += kBlockSize)
+            limiterProcess(limiter, scratch + i, (length - i < kBlockSize) ? length - i : kBlockSize);
+        times[r] = benchNow() - start;
+    }
+
+    for (int i = 1; i < kRepeats; i++)
+        for (int j = i; j > 0 && times[j] < times[j - 1]; j--) {
+            double t = times[j];
+            times[j] = times[j - 1];
+            times[j - 1] = t;
+        }
+
+    return times[kRepeats / 2];
+}
+
+int main(int argc, char **argv) {
+
+    int check = benchCheckMode(argc, argv);
+    int length = (int)(kSampleRate * (check ? 5 : 60));
+    int failed = 0;
+
+    float *program = (float *)malloc(length * sizeof(float));
+    float *scratch = (float *)malloc(length * sizeof(float));
+    makeProgram(program, length);
+
+    const float lookaheads[] = { 0.5f, 1.0f, 1.5f, 2.5f, 5.0f, 7.5f, 10.0f };
+    const int nLookaheads = sizeof(lookaheads) / sizeof(lookaheads[0]);
+    double nsPerSample[sizeof(lookaheads) / sizeof(lookaheads[0])];
+
+    printf("Limiter, %.0f s of audio in %d-sample blocks (median of %d)\n", length / kSampleRate, kBlockSize, kRepeats);
+    printf("%14s %10s %14s %12s %12s\n", "look-ahead ms", "latency", "ns/sample", "real-time x", "peak out");
+
+    for (int k = 0; k < nLookaheads; k++) {
+
+        Limiter *limiter = limiterCreate(kSampleRate);
+        limiterSetLookahead(limiter, lookaheads[k]);
+
+        double seconds = timeLimiter(limiter, program, scratch, length);
+        nsPerSample[k] = 1e9 * seconds / length;
+
+        float peak = 0.0f;
+        for (int i = 0; i < length; i++)
+            if (fabsf(scratch[i]) > peak)
+                peak = fabsf(scratch[i]);
+
+        printf("%14.1f %10d %14.2f %12.0f %12.4f\n", lookaheads[k], limiterGetLatency(limiter),
+               nsPerSample[k], (length / kSampleRate) / seconds, peak);
+
+        if (check && peak > kLimiterDefaultCeiling + 1e-6f) {
+            printf("FAIL: peak %f over the ceiling at %.1f ms look-ahead\n", peak, lookaheads[k]);
+            failed = 1;
+        }
+
+        limiterDestroy(limiter);
+    }
+
+    if (check) {
+
+        /* Below the ceiling the limiter is a pure delay */
+        Limiter *limiter = limiterCreate(kSampleRate);
+        int latency = limiterGetLatency(limiter);
+        for (int i = 0; i < length; i++)
+            program[i] = scratch[i] = 0.5f * sinf(0.01f * i);
+        limiterProcess(limiter, scratch, length);
+        limiterDestroy(limiter);
+
+        double error = 0.0;
+        for (int i = latency; i < length; i++)
+            error = fmax(error, fabs(scratch[i] - program[i - latency]));
+        if (error > 1e-6) {
+            printf("FAIL: pass-through error %g below the ceiling\n", error);
+            failed = 1;
+        }
+
+        if (nsPerSample[nLookaheads - 1] > 3.0 * nsPerSample[0]) {
+            printf("FAIL: %.1f ms look-ahead costs %.1fx %.1f ms\n", lookaheads[nLookaheads - 1],
+                   nsPerSample[nLookaheads - 1] / nsPerSample[0], lookaheads[0]);
+            failed = 1;
+        }
+    }
+
+    free(program);
+    free(scratch);
+
+    return failed;
+}
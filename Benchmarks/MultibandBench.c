@@ -0,0 +1,144 @@
+//
+//  MultibandBench.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Multiband distortion cost per band count, and how far the unclipped band sum is from a flat magnitude response (8192-point impulse response, every bin up to Nyquist) at 44.1 and 48 kHz.
+
+    --check fails if any band count at either rate deviates from unity magnitude by more than kFlatnessBound, or if a band count change made between calls leaves stale filter state behind.
+ */
+
+#include "BenchUtil.h"
+#include "MultibandDistortion.h"
+
+#include <math.h>
+
+#define kSampleRate 44100.0f
+#define kBlockSize 1024
+#define kImpulseLength 8192
+#define kFlatnessBound 5e-4
+
+/* Largest |H(k)| - 1 over the DFT bins of the impulse response */
+static double flatnessError(int nBands, float sampleRate) {
+
+    MultibandDistortion *mb = multibandCreate(sampleRate);
+    multibandSetNumBands(mb, nBands);
+
+    float *h = (float *)calloc(kImpulseLength, sizeof(float));
+    h[0] = 1.0f;
+    multibandProcess(mb, h, kImpulseLength, 1e6f);     // Thresholds far above the signal: no clipping
+    multibandDestroy(mb);
+
+    double worst = 0.0;
+
+    for (int k = 0; k <= kImpulseLength / 2; k++) {
+
+        /* Rotate a phasor rather than calling cos/sin per sample */
+        double step = -2.0 * 3.14159265358979323846 * k / kImpulseLength;
+        double stepRe = cos(step), stepIm = sin(step);
+        double wRe = 1.0, wIm = 0.0, re = 0.0, im = 0.0;
+
+        for (int n = 0; n < kImpulseLength; n++) {
+            re += h[n] * wRe;
+            im += h[n] * wIm;
+            double t = wRe * stepRe - wIm * stepIm;
+            wIm = wRe * stepIm + wIm * stepRe;
+            wRe = t;
+        }
+
+        double error = fabs(sqrt(re * re + im * im) - 1.0);
+        if (error > worst)
+            worst = error;
+    }
+
+    free(h);
+
+    return worst;
+}
+
+int main(int argc, char **argv) {
+
+    int check = benchCheckMode(argc, argv);
+    int length = (int)(kSampleRate * (check ? 5 : 60));
+    int failed = 0;
+
+    float *program = (float *)malloc(length * sizeof(float));
+    float *scratch = (float *)malloc(length * sizeof(float));
+    benchNoise(program, length, 5);
+    for (int i = 0; i < length; i++)
+        program[i] = 0.7f * sinf(0.031f * i) + 0.3f * program[i];
+
+    printf("Multiband distortion, %.0f s of audio in %d-sample blocks\n", length / kSampleRate, kBlockSize);
+    printf("%6s %14s %12s %16s %16s\n", "bands", "ns/sample", "real-time x", "|H|-1 44.1 kHz", "|H|-1 48 kHz");
+
+    for (int nBands = kMultibandMinBands; nBands <= kMultibandMaxBands; nBands++) {
+
+        MultibandDistortion *mb = multibandCreate(kSampleRate);
+        multibandSetNumBands(mb, nBands);
+        for (int band = 0; band < nBands; band += 2)
+            multibandSetShape(mb, band, kMultibandSoftClip);
+
+        memcpy(scratch, program, length * sizeof(float));
+
+        double start = benchNow();
+        for (int i = 0; i < length; i += kBlockSize)
+            multibandProcess(mb, scratch + i, (length - i < kBlockSize) ? length - i : kBlockSize, 0.5f);
+        double seconds = benchNow() - start;
+
+        multibandDestroy(mb);
+
+        double flatness44 = flatnessError(nBands, 44100.0f);
+        double flatness48 = flatnessError(nBands, 48000.0f);
+
+        printf("%6d %14.2f %12.0f %16.2e %16.2e\n", nBands, 1e9 * seconds / length, (length / kSampleRate) / seconds,
+               flatness44, flatness48);
+
+        if (check && (flatness44 > kFlatnessBound || flatness48 > kFlatnessBound)) {
+            printf("FAIL: %d bands deviate %.2e from flat (bound %.0e)\n", nBands, fmax(flatness44, flatness48), kFlatnessBound);
+            failed = 1;
+        }
+    }
+
+    if (check) {
+
+        /* Switching 3 -> 5 bands between calls must behave like a fresh 5-band instance */
+        MultibandDistortion *switched = multibandCreate(kSampleRate);
+        MultibandDistortion *fresh = multibandCreate(kSampleRate);
+        multibandSetNumBands(switched, 3);
+        multibandSetNumBands(fresh, 5);
+
+        memcpy(scratch, program, kBlockSize * sizeof(float));
+        multibandProcess(switched, scratch, kBlockSize, 0.5f);
+
+        multibandSetNumBands(switched, 5);
+        if (multibandGetNumBands(switched) != 5) {
+            printf("FAIL: band count not reported until applied\n");
+            failed = 1;
+        }
+
+        float *a = scratch, *b = scratch + kBlockSize;
+        memcpy(a, program + kBlockSize, kBlockSize * sizeof(float));
+        memcpy(b, program + kBlockSize, kBlockSize * sizeof(float));
+        multibandProcess(switched, a, kBlockSize, 0.5f);
+        multibandProcess(fresh, b, kBlockSize, 0.5f);
+
+        for (int i = 0; i < kBlockSize; i++)
+            if (a[i] != b[i]) {
+                printf("FAIL: sample %d differs after a band count change (%g vs %g)\n", i, a[i], b[i]);
+                failed = 1;
+                break;
+            }
+
+        multibandDestroy(switched);
+        multibandDestroy(fresh);
+    }
+
+    free(program);
+    free(scratch);
+
+    return failed;
+}
@@ -0,0 +1,248 @@
+//
+//  PhaseVocoderBench.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Phase vocoder real-time factor (processing time / audio duration) across FFT sizes and overlaps, for the streaming pitch shifter (phaseVocoderProcess) and the offline time-stretch (phaseVocoderTimeStretch).
+
+    --check fails if a sine's level after pitch shifting (ratios 0.5-2) or time-stretching (0.5-3) is off by more than kLevelToleranceDB, if the pitch-shifted frequency is off by more than 0.5%, or if sweeping the ratio within one octave of the output FIFO sizing runs the FIFO dry.
+ */
+
+#include "BenchUtil.h"
+#include "PhaseVocoder.h"
+
+#include <math.h>
+
+#define kSampleRate 44100.0
+#define kBlockSize 512
+#define kLevelToleranceDB 0.5
+#define kSineAmplitude 0.5
+
+static void makeSine(float *data, int length, double frequency) {
+
+    for (int i = 0; i < length; i++)
+        data[i] = kSineAmplitude * sin(2.0 * 3.14159265358979323846 * frequency * i / kSampleRate);
+}
+
+/* Level relative to the input sine, dB */
+static double levelDB(const float *data, int length) {
+
+    double sum = 0.0;
+    for (int i = 0; i < length; i++)
+        sum += (double)data[i] * data[i];
+
+    return 20.0 * log10(sqrt(sum / length) / (kSineAmplitude * sqrt(0.5)));
+}
+
+/* Mean frequency from rising zero crossings */
+static double zeroCrossingFrequency(const float *data, int length) {
+
+    int first = -1, last = -1, count = 0;
+
+    for (int i = 1; i < length; i++)
+        if (data[i - 1] < 0.0f && data[i] >= 0.0f) {
+            if (first < 0)
+                first = i;
+            last = i;
+            count++;
+        }
+
+    return (count > 1) ? (count - 1) * kSampleRate / (last - first) : 0.0;
+}
+
+static void pitchShift(PhaseVocoder *pv, float *data, int length) {
+
+    for (int i = 0; i < length; i += kBlockSize)
+        phaseVocoderProcess(pv, data + i, (length - i < kBlockSize) ? length - i : kBlockSize);
+}
+
+static int checkLevels(void) {
+
+    const double frequencies[] = { 110.0, 440.0, 1000.0, 3000.0 };
+    const float ratios[] = { 0.5f, 0.75f, 0.8909f, 1.0f, 1.25f, 1.4983f, 2.0f };
+    const float stretches[] = { 0.5f, 0.75f, 1.0f, 1.5f, 2.0f, 3.0f };
+    const int length = (int)(3 * kSampleRate);
+    const int settle = 2 * kPhaseVocoderDefaultFFTSize;
+
+    float *in = (float *)malloc(length * sizeof(float));
+    float *out = (float *)malloc(3 * length * sizeof(float));
+    int failed = 0;
+
+    printf("Sine level (dB) after pitch shift / time-stretch, fftSize %d, overlap %d\n",
+           kPhaseVocoderDefaultFFTSize, kPhaseVocoderDefaultOverlap);
+
+    for (int f = 0; f < (int)(sizeof(frequencies) / sizeof(frequencies[0])); f++) {
+
+        printf("%6.0f Hz  pitch:", frequencies[f]);
+
+        for (int r = 0; r < (int)(sizeof(ratios) / sizeof(ratios[0])); r++) {
+
+            PhaseVocoder *pv = phaseVocoderCreate(kPhaseVocoderDefaultFFTSize, kPhaseVocoderDefaultOverlap);
+            phaseVocoderSetPitchRatio(pv, ratios[r]);
+
+            makeSine(out, length, frequencies[f]);
+            pitchShift(pv, out, length);
+            int start = phaseVocoderGetLatency(pv) + settle;
+            phaseVocoderDestroy(pv);
+
+            double level = levelDB(out + start, length - start);
+            double frequency = zeroCrossingFrequency(out + start, length - start);
+            double expected = frequencies[f] * ratios[r];
+            printf(" %.2f:%+.2f", ratios[r], level);
+
+            if (fabs(level) > kLevelToleranceDB || fabs(frequency - expected) > 0.005 * expected) {
+                printf("\nFAIL: ratio %.4f at %.0f Hz: level %+.2f dB, frequency %.2f (expected %.2f)\n",
+                       ratios[r], frequencies[f], level, frequency, expected);
+                failed = 1;
+            }
+        }
+
+        printf("\n%6.0f Hz stretch:", frequencies[f]);
+
+        for (int s = 0; s < (int)(sizeof(stretches) / sizeof(stretches[0])); s++) {
+
+            makeSine(in, length, frequencies[f]);
+            int n = phaseVocoderTimeStretch(in, length, out, 3 * length, stretches[s],
+                                            kPhaseVocoderDefaultFFTSize, kPhaseVocoderDefaultOverlap, 0);
+
+            /* Skip the edges, where frames overlap-add with the zero padding */
+            double level = levelDB(out + settle, n - 2 * settle);
+            printf(" %.2f:%+.2f", stretches[s], level);
+
+            if (fabs(level) > kLevelToleranceDB || n != (int)(length * stretches[s] + 0.5f)) {
+                printf("\nFAIL: stretch %.2f at %.0f Hz: level %+.2f dB, %d samples\n", stretches[s], frequencies[f], level, n);
+                failed = 1;
+            }
+        }
+
+        printf("\n");
+    }
+
+    free(in);
+    free(out);
+
+    return failed;
+}
+
+/* Ratio moving every block within [low, high], as from a slider. Returns the number of silent (exactly zero) output samples after the latency, which only an output FIFO underrun produces */
+static int sweepUnderruns(int fftSize, int overlap, float low, float high) {
+
+    const int length = (int)(4 * kSampleRate);
+    float *data = (float *)malloc(length * sizeof(float));
+
+    makeSine(data, length, 440.0);
+    for (int i = 0; i < length; i++)
+        data[i] += 0.1f;        // No zero crossings on sample boundaries
+
+    PhaseVocoder *pv = phaseVocoderCreate(fftSize, overlap);
+    phaseVocoderSetPitchRatio(pv, high);
+    int start = phaseVocoderGetLatency(pv) + fftSize;
+
+    for (int i = 0, b = 0; i < length; i += kBlockSize, b++) {
+        phaseVocoderSetPitchRatio(pv, low + (high - low) * (0.5f + 0.5f * sinf(0.05f * b)));
+        phaseVocoderProcess(pv, data + i, (length - i < kBlockSize) ? length - i : kBlockSize);
+    }
+
+    int silent = 0;
+    for (int i = start; i < length; i++)
+        silent += (data[i] == 0.0f);
+
+    phaseVocoderDestroy(pv);
+    free(data);
+
+    return silent;
+}
+
+/* Ratio sweeps within each octave of the FIFO sizing must never run the output dry */
+static int checkSweeps(void) {
+
+    const float bands[][2] = { { 1.0f, 4.0f }, { 0.5f, 0.99f }, { 0.25f, 0.49f } };
+    const int sizes[][2] = { { 512, 4 }, { 2048, 4 }, { 4096, 8 } };
+    int failed = 0;
+
+    printf("Output FIFO underruns with the ratio swept every %d-sample block\n", kBlockSize);
+
+    for (int z = 0; z < 3; z++) {
+
+        printf("%6d/%d:", sizes[z][0], sizes[z][1]);
+
+        for (int b = 0; b < 3; b++) {
+
+            PhaseVocoder *pv = phaseVocoderCreate(sizes[z][0], sizes[z][1]);
+            phaseVocoderSetPitchRatio(pv, bands[b][0]);
+            int latency = phaseVocoderGetLatency(pv);
+            phaseVocoderDestroy(pv);
+
+            int silent = sweepUnderruns(sizes[z][0], sizes[z][1], bands[b][0], bands[b][1]);
+            printf("  %.2f-%.2f latency %5d, %d silent", bands[b][0], bands[b][1], latency, silent);
+
+            if (silent > 0) {
+                printf("\nFAIL: %d underrun samples sweeping %.2f-%.2f at %d/%d\n", silent, bands[b][0], bands[b][1],
+                       sizes[z][0], sizes[z][1]);
+                failed = 1;
+            }
+        }
+
+        printf("\n");
+    }
+
+    return failed;
+}
+
+int main(int argc, char **argv) {
+
+    int check = benchCheckMode(argc, argv);
+    int failed = 0;
+
+    const int sizes[] = { 512, 1024, 2048, 4096 };
+    const int overlaps[] = { 4, 8 };
+    const int length = (int)(kSampleRate * (check ? 2 : 20));
+
+    float *in = (float *)malloc(length * sizeof(float));
+    float *out = (float *)malloc(2 * length * sizeof(float));
+
+    /* A chord rather than one sine, so each frame has a realistic number of peaks */
+    makeSine(in, length, 220.0);
+    for (int i = 0; i < length; i++)
+        in[i] += 0.3f * sinf(0.0427f * i) + 0.2f * sinf(0.1131f * i);
+
+    printf("Real-time factor, %.0f s of audio (pitch shift at 1.26 in %d-sample blocks; time-stretch by 1.5)\n",
+           length / kSampleRate, kBlockSize);
+    printf("%8s %8s %10s %14s %14s\n", "fftSize", "overlap", "latency", "pitch RTF", "stretch RTF");
+
+    for (int a = 0; a < (int)(sizeof(sizes) / sizeof(sizes[0])); a++) {
+        for (int b = 0; b < (int)(sizeof(overlaps) / sizeof(overlaps[0])); b++) {
+
+            PhaseVocoder *pv = phaseVocoderCreate(sizes[a], overlaps[b]);
+            phaseVocoderSetPitchRatio(pv, 1.26f);
+            phaseVocoderSetTransientPreserving(pv, 1);
+
+            memcpy(out, in, length * sizeof(float));
+            double start = benchNow();
+            pitchShift(pv, out, length);
+            double pitchTime = benchNow() - start;
+
+            int latency = phaseVocoderGetLatency(pv);
+            phaseVocoderDestroy(pv);
+
+            start = benchNow();
+            phaseVocoderTimeStretch(in, length, out, 2 * length, 1.5f, sizes[a], overlaps[b], 1);
+            double stretchTime = benchNow() - start;
+
+            double duration = length / kSampleRate;
+            printf("%8d %8d %10d %14.4f %14.4f\n", sizes[a], overlaps[b], latency, pitchTime / duration, stretchTime / duration);
+        }
+    }
+
+    free(in);
+    free(out);
+
+    if (check)
+        failed = checkLevels() | checkSweeps();
+
+    return failed;
+}
@@ -0,0 +1,225 @@
+//
+//  SampleConversionBench.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Memory footprint, append/read throughput and cache miss rate of the history buffers in each storage format. The ring goes through packSamplesRing()/unpackSamplesRing(), the same wrap-around code CircularBuffer uses (only the Objective-C wrapper and readMostRecentWithLength:'s start index are mirrored here), sized like AudioController's histories (kMaxDelayTime at 44.1 kHz) and driven with render-callback sized blocks.
+
+    --check verifies the footprints against the bytes the kernels actually write, a read across the end of the ring, and the round-trip accuracy bounds documented in SampleConversion.h.
+ */
+
+#include "BenchUtil.h"
+#include "SampleConversion.h"
+
+#include <math.h>
+
+#define kSampleRate 44100
+#define kHistoryLength (2 * kSampleRate)
+#define kBlockSize 1024
+
+typedef struct Ring {
+    void *storage;
+    int length;
+    int writeIdx;
+    SampleStorageFormat format;
+} Ring;
+
+/* As CircularBuffer's writeDataWithLength: */
+static void ringWrite(Ring *ring, const float *data, int length) {
+
+    ring->writeIdx = packSamplesRing(data, ring->storage, ring->length, ring->writeIdx, length, ring->format);
+}
+
+/* As CircularBuffer's readMostRecentWithLength: */
+static void ringReadMostRecent(Ring *ring, float *data, int length) {
+
+    int readIdx = ring->writeIdx - length;
+    if (readIdx < 0)
+        readIdx += ring->length;
+
+    unpackSamplesRing(ring->storage, ring->length, readIdx, data, length, ring->format);
+}
+
+/* Bytes a full ring's worth of writes actually touches, found from storage pre-filled with two different patterns */
+static size_t touchedBytes(SampleStorageFormat format, const float *block) {
+
+    size_t capacity = (size_t)kHistoryLength * sizeof(double);
+    unsigned char *storage = (unsigned char *)malloc(capacity);
+    size_t touched = 0;
+
+    for (int pattern = 0x00; pattern <= 0xFF; pattern += 0xFF) {
+
+        memset(storage, pattern, capacity);
+        for (int i = 0; i < kHistoryLength; i += kBlockSize)
+            packSamples(block, storage, i, (kHistoryLength - i < kBlockSize) ? kHistoryLength - i : kBlockSize, format);
+
+        for (size_t i = capacity; i > touched; i--)
+            if (storage[i - 1] != pattern) {
+                touched = i;
+                break;
+            }
+    }
+
+    free(storage);
+
+    return touched;
+}
+
+static const char *formatName(SampleStorageFormat format) {
+
+    switch (format) {
+        case kSampleStorageInt16:   return "Int16";
+        case kSampleStorageFloat16: return "Float16";
+        default:                    return "Float32";
+    }
+}
+
+/* Largest round-trip error over input in [-1, 1] relative to the documented bound. Returns > 1 on a violation */
+static double worstErrorRatio(SampleStorageFormat format, const float *in, int length) {
+
+    float *out = (float *)malloc(length * sizeof(float));
+    void *storage = malloc(length * bytesPerSample(format));
+    double worst = 0.0;
+
+    packSamples(in, storage, 0, length, format);
+    unpackSamples(storage, 0, out, length, format);
+
+    for (int i = 0; i < length; i++) {
+
+        double bound;
+        if (format == kSampleStorageInt16)
+            bound = 0.5 / 32767.0 + 1e-7;
+        else if (format == kSampleStorageFloat16)
+            bound = (fabsf(in[i]) >= ldexpf(1.0f, -14)) ? fabsf(in[i]) * ldexp(1.0, -11) : ldexp(1.0, -25);
+        else
+            bound = 0.0;
+
+        double error = fabs((double)out[i] - in[i]);
+        double ratio = (bound > 0.0) ? error / bound : (error > 0.0 ? 2.0 : 0.0);
+        if (ratio > worst)
+            worst = ratio;
+    }
+
+    free(storage);
+    free(out);
+
+    return worst;
+}
+
+int main(int argc, char **argv) {
+
+    int check = benchCheckMode(argc, argv);
+    int seconds = check ? 2 : 120;
+    int nBlocks = seconds * kSampleRate / kBlockSize;
+    int failed = 0;
+
+    float *in = (float *)malloc(kBlockSize * sizeof(float));
+    float *out = (float *)malloc(kBlockSize * sizeof(float));
+    benchNoise(in, kBlockSize, 1);
+
+    BenchCounters counters;
+    int haveCounters = benchCountersOpen(&counters);
+
+    printf("History buffer: %d samples, %d-sample blocks, %d s of audio (kernels: %s)\n", kHistoryLength, kBlockSize, seconds,
+           sampleConversionKernels());
+    printf("%-8s %12s %16s %16s %12s\n", "format", "footprint", "append (Ms/s)", "read (Ms/s)", "cache miss");
+
+    SampleStorageFormat formats[] = { kSampleStorageFloat32, kSampleStorageInt16, kSampleStorageFloat16 };
+
+    for (int f = 0; f < 3; f++) {
+
+        Ring ring;
+        ring.format = formats[f];
+        ring.length = kHistoryLength;
+        ring.writeIdx = 0;
+        ring.storage = calloc(ring.length, bytesPerSample(ring.format));
+
+        size_t footprint = ring.length * bytesPerSample(ring.format);
+
+        /* Fault the storage in before timing */
+        for (int b = 0; b < kHistoryLength / kBlockSize + 1; b++)
+            ringWrite(&ring, in, kBlockSize);
+
+        /* Appends alone */
+        double start = benchNow();
+        for (int b = 0; b < nBlocks; b++)
+            ringWrite(&ring, in, kBlockSize);
+        double appendTime = benchNow() - start;
+
+        /* Reads alone */
+        start = benchNow();
+        for (int b = 0; b < nBlocks; b++) {
+            ringReadMostRecent(&ring, out, kBlockSize);
+            in[b & (kBlockSize - 1)] += out[0] * 1e-30f;       // Keep the reads live
+        }
+        double readTime = benchNow() - start;
+
+        /* The render callback pattern, one append and one read per block, for the cache counters */
+        benchCountersStart(&counters);
+        for (int b = 0; b < nBlocks; b++) {
+            ringWrite(&ring, in, kBlockSize);
+            ringReadMostRecent(&ring, out, kBlockSize);
+        }
+        double missRate = benchCountersStop(&counters);
+
+        char miss[32];
+        if (missRate >= 0.0)
+            snprintf(miss, sizeof(miss), "%.2f%%", 100.0 * missRate);
+        else
+            snprintf(miss, sizeof(miss), "n/a");
+
+        double samples = (double)nBlocks * kBlockSize;
+        printf("%-8s %10zu B %16.1f %16.1f %12s\n", formatName(ring.format), footprint,
+               1e-6 * samples / appendTime, 1e-6 * samples / readTime, miss);
+
+        if (check) {
+
+            /* The allocation must match both the bytes the kernels write and the size the format should take */
+            size_t expected = kHistoryLength * (ring.format == kSampleStorageFloat32 ? 4 : 2);
+            size_t touched = touchedBytes(ring.format, in);
+            if (footprint != expected || touched != expected) {
+                printf("FAIL: %s allocates %zu bytes and writes %zu, expected %zu\n", formatName(ring.format),
+                       footprint, touched, expected);
+                failed = 1;
+            }
+
+            /* A block written across the end of the ring reads back as a straight round trip would */
+            float expectedBlock[kBlockSize];
+            uint32_t scratch[kBlockSize];
+            packSamples(in, scratch, 0, kBlockSize, ring.format);
+            unpackSamples(scratch, 0, expectedBlock, kBlockSize, ring.format);
+
+            ring.writeIdx = ring.length - kBlockSize / 3;
+            ringWrite(&ring, in, kBlockSize);
+            ringReadMostRecent(&ring, out, kBlockSize);
+            if (ring.writeIdx != kBlockSize - kBlockSize / 3 || memcmp(out, expectedBlock, sizeof(expectedBlock)) != 0) {
+                printf("FAIL: %s read across the wrap doesn't match the written block\n", formatName(ring.format));
+                failed = 1;
+            }
+
+            float *noise = (float *)malloc(kHistoryLength * sizeof(float));
+            benchNoise(noise, kHistoryLength, 2 + f);
+            double ratio = worstErrorRatio(ring.format, noise, kHistoryLength);
+            free(noise);
+            if (ratio > 1.0) {
+                printf("FAIL: %s round-trip error %.2fx the documented bound\n", formatName(ring.format), ratio);
+                failed = 1;
+            }
+        }
+
+        free(ring.storage);
+    }
+
+    if (!haveCounters)
+        printf("(cache counters unavailable: perf_event_open refused)\n");
+
+    benchCountersClose(&counters);
+    free(in);
+    free(out);
+
+    return failed;
+}
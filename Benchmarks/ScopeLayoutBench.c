@@ -0,0 +1,322 @@
+//
+//  ScopeLayoutBench.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Label layer frame cost over a simulated pan/zoom gesture. Each frame moves the visible plot bounds, re-runs the grid auto-scaling from METScopeView's setPlotUnitsPerTick, and updates a cached layer the way METScopeCachedLayerView does: compare against the cached state, then redraw the whole view or only the dirty rects, laying out the labels that can reach them in one pass as METScopeLabelView does. Glyph rendering is replaced by a malloc, so the timings cover the layout and label work, and the dirty area stands in for the rasterization cost.
+
+    Reports, for pan and pinch frames separately, the fraction of frames re-rasterized in full, the mean dirty area as a fraction of the view (1 for a full redraw), glyph cache misses per frame, labels laid out per frame (and what a full redraw of the same states would lay out) and the layout cost per frame.
+
+    --check fails if a pan re-rasterizes more than 5% of its frames or dirties more than half the view on average (the fixed label bands alone are about 15%), if panning renders more than one glyph per frame or lays out more labels than full redraws of the same states would, or if the translated cache drifts from the true origin by more than half a device pixel.
+ */
+
+#include "BenchUtil.h"
+#include "ScopeLayout.h"
+
+#include <math.h>
+
+/* Label view of an iPad-sized scope, x labels outside below and y labels outside left */
+#define kViewWidth 700.0f
+#define kViewHeight 300.0f
+#define kPixelScale 2.0f
+#define kXBandHeight (15.0f + 12.0f)
+#define kYBandWidth (28.0f + 12.0f)
+
+/* As METScopeView.h and METScopeLabelView */
+#define kMaxXTicksInFrame 6.0f
+#define kMinXTicksInFrame 4.0f
+#define kMaxYTicksInFrame 5.0f
+#define kMinYTicksInFrame 3.0f
+#define kGlyphCacheCapacity 256
+#define kMaxLabelWidth 64.0f
+#define kMaxLabelHeight 16.0f
+#define kXLabelY (kViewHeight - 13.0f)
+#define kXLabelOffset (-14.0f)
+#define kYLabelX 2.0f
+
+#define kSegmentFrames 120      // Frames per gesture segment: two pans, then a pinch
+
+typedef struct Scope {
+    float xMin, xMax, yMin, yMax;
+    float xTick, yTick;
+    char xFormat[32];
+    char yFormat[32];
+} Scope;
+
+typedef struct FrameStats {
+    int frames;
+    int redraws;
+    int misses;
+    long labels;                // Labels laid out
+    long fullLabels;            // Labels a full redraw of the same states would lay out
+    double dirtyArea;
+    double seconds;
+} FrameStats;
+
+static int liveGlyphs = 0;
+
+static void releaseGlyph(void *glyph) {
+    free(glyph);
+    liveGlyphs--;
+}
+
+/* Tick spacing and label formats for the visible range, as setPlotUnitsPerTick with auto-scaling on both axes */
+static void autoScale(Scope *s) {
+    s->xTick = scopeAutoTickSpacing(s->xMax - s->xMin, s->xTick, kMinXTicksInFrame, kMaxXTicksInFrame, s->xFormat, sizeof(s->xFormat));
+    s->yTick = scopeAutoTickSpacing(s->yMax - s->yMin, s->yTick, kMinYTicksInFrame, kMaxYTicksInFrame, s->yFormat, sizeof(s->yFormat));
+}
+
+static ScopeLayoutState layoutState(const Scope *s) {
+
+    ScopeLayoutState state;
+    memset(&state, 0, sizeof(state));
+
+    float unitsPerPixelX = (s->xMax - s->xMin) / kViewWidth;
+    float unitsPerPixelY = (s->yMax - s->yMin) / kViewHeight;
+
+    state.width = kViewWidth;
+    state.height = kViewHeight;
+    state.originX = -s->xMin / unitsPerPixelX;
+    state.originY = s->yMax / unitsPerPixelY;
+    state.tickUnitsX = s->xTick;
+    state.tickUnitsY = s->yTick;
+    state.tickPixelsX = s->xTick / unitsPerPixelX;
+    state.tickPixelsY = s->yTick / unitsPerPixelY;
+    state.style = scopeLayoutHash(0, s->xFormat, strlen(s->xFormat) + 1);
+    state.style = scopeLayoutHash(state.style, s->yFormat, strlen(s->yFormat) + 1);
+
+    return state;
+}
+
+static void drawLabel(ScopeLabelCache *cache, ScopeAxis axis, int index, const char *format, double value, FrameStats *stats) {
+
+    if (scopeLabelCacheFindTick(cache, axis, index))
+        return;
+
+    char text[kScopeLabelMaxLength * 2];
+    scopeFormatLabel(text, sizeof(text), format, value);
+
+    if (!scopeLabelCacheFind(cache, text)) {
+        void *glyph = malloc(64);
+        stats->misses++;
+        liveGlyphs++;
+        if (!scopeLabelCacheInsert(cache, text, glyph))
+            releaseGlyph(glyph);
+    }
+
+    scopeLabelCacheInsertTick(cache, axis, index, text);
+}
+
+static int rectsIntersect(const ScopeRect *a, const ScopeRect *b) {
+    return a->x <= b->x + b->width && b->x <= a->x + a->width && a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+static int reachesAny(ScopeRect label, const ScopeRect *rects, int count) {
+
+    for (int i = 0; i < count; i++)
+        if (rectsIntersect(&label, &rects[i]))
+            return 1;
+    return 0;
+}
+
+/* Lay out the labels that can reach any of the dirty rects in one pass, as METScopeLabelView does (looking glyphs up by tick index, then by label). Returns the number of labels laid out; with no cache, only counts them */
+static int drawLabels(ScopeLabelCache *cache, const Scope *s, const ScopeLayoutState *state,
+                      const ScopeRect *rects, int count, FrameStats *stats) {
+
+    ScopeTicks ticks;
+    int nLabels = 0;
+    float minPixel, maxPixel;
+
+    if (cache)
+        scopeLabelCacheSetTickState(cache, state);
+
+    minPixel = state->width;
+    maxPixel = 0;
+    for (int i = 0; i < count; i++) {
+        if (rects[i].y + rects[i].height < kXLabelY || rects[i].y > kXLabelY + 2 + kMaxLabelHeight)
+            continue;
+        minPixel = fminf(minPixel, rects[i].x - kXLabelOffset - kMaxLabelWidth);
+        maxPixel = fmaxf(maxPixel, rects[i].x + rects[i].width - kXLabelOffset);
+    }
+
+    scopeTicksCompute(&ticks, state->originX, state->tickPixelsX, fmaxf(minPixel, 0), fminf(maxPixel, state->width));
+    for (int i = 0; i < ticks.nTicks; i++) {
+        ScopeRect extent = { ticks.pixel[i] + kXLabelOffset, kXLabelY + 2 * (ticks.index[i] < 0), kMaxLabelWidth, kMaxLabelHeight };
+        if (!reachesAny(extent, rects, count))
+            continue;
+        nLabels++;
+        if (cache)
+            drawLabel(cache, kScopeAxisX, ticks.index[i], s->xFormat, ticks.index[i] * state->tickUnitsX, stats);
+    }
+
+    minPixel = state->height;
+    maxPixel = 0;
+    for (int i = 0; i < count; i++) {
+        if (rects[i].x + rects[i].width < kYLabelX || rects[i].x > kYLabelX + kMaxLabelWidth)
+            continue;
+        minPixel = fminf(minPixel, rects[i].y + 14 - kMaxLabelHeight);
+        maxPixel = fmaxf(maxPixel, rects[i].y + rects[i].height + 14);
+    }
+
+    scopeTicksCompute(&ticks, state->originY, state->tickPixelsY, fmaxf(minPixel, 0), fminf(maxPixel, state->height));
+    for (int i = 0; i < ticks.nTicks; i++) {
+        ScopeRect extent = { kYLabelX, ticks.pixel[i] - 14, kMaxLabelWidth, kMaxLabelHeight };
+        if (!reachesAny(extent, rects, count))
+            continue;
+        nLabels++;
+        if (cache)
+            drawLabel(cache, kScopeAxisY, ticks.index[i], s->yFormat, -ticks.index[i] * state->tickUnitsY, stats);
+    }
+
+    return nLabels;
+}
+
+/* Move the visible bounds for frame f: a Lissajous pan of a few points per frame, or a pinch about the center */
+static int gestureStep(Scope *s, int f) {
+
+    float rangeX = s->xMax - s->xMin;
+    float rangeY = s->yMax - s->yMin;
+    int pinch = (f / kSegmentFrames) % 3 == 2;
+
+    if (!pinch) {
+        float px = sinf(f * 0.05f) * 3.0f * rangeX / kViewWidth;
+        float py = cosf(f * 0.037f) * 2.0f * rangeY / kViewHeight;
+        s->xMin += px;
+        s->xMax += px;
+        s->yMin += py;
+        s->yMax += py;
+    }
+    else {
+        float zoom = 1.0f + 0.01f * sinf(f * 0.1f);
+        float cx = 0.5f * (s->xMin + s->xMax);
+        float cy = 0.5f * (s->yMin + s->yMax);
+        s->xMin = cx - 0.5f * rangeX * zoom;
+        s->xMax = cx + 0.5f * rangeX * zoom;
+        s->yMin = cy - 0.5f * rangeY * zoom;
+        s->yMax = cy + 0.5f * rangeY * zoom;
+    }
+
+    return pinch;
+}
+
+static void printStats(const char *name, const FrameStats *stats) {
+
+    int n = stats->frames ? stats->frames : 1;
+
+    printf("%-8s %8d %10.1f%% %12.1f%% %12.3f %8.2f (%.2f) %12.0f\n", name, stats->frames, 100.0 * stats->redraws / n,
+           100.0 * stats->dirtyArea / n, (double)stats->misses / n, (double)stats->labels / n,
+           (double)stats->fullLabels / n, 1e9 * stats->seconds / n);
+}
+
+int main(int argc, char **argv) {
+
+    int check = benchCheckMode(argc, argv);
+    int nFrames = check ? 20000 : 200000;
+    int failed = 0;
+
+    /* A 23 ms window of a +/-1.25 signal, as the time-domain scope shows it */
+    Scope scope = { -0.0001f, 0.023f, -1.25f, 1.25f, 0.005f, 0.5f, "", "" };
+    autoScale(&scope);
+
+    ScopeLabelCache *cache = scopeLabelCacheCreate(kGlyphCacheCapacity, releaseGlyph);
+    ScopeLayoutState cached = layoutState(&scope);
+    ScopeRect bands[2] = { { 0, kViewHeight - kXBandHeight, kViewWidth, kXBandHeight },
+                           { 0, 0, kYBandWidth, kViewHeight } };
+    ScopeRect bounds = { 0, 0, kViewWidth, kViewHeight };
+
+    FrameStats stats[2];
+    memset(stats, 0, sizeof(stats));
+    double maxDrift = 0.0;
+
+    for (int f = 0; f < nFrames; f++) {
+
+        FrameStats *frame = &stats[gestureStep(&scope, f)];
+        autoScale(&scope);
+        frame->frames++;
+
+        double start = benchNow();
+
+        ScopeLayoutState state = layoutState(&scope);
+        ScopeRect dirty[kScopeMaxDirtyRects];
+        float dx, dy;
+        int nDirty = 0;
+
+        ScopeLayoutChange change = scopeLayoutCompare(&cached, &state, kPixelScale, &dx, &dy);
+
+        if (change == kScopeLayoutRedraw) {
+            cached = state;
+            frame->redraws++;
+            frame->dirtyArea += 1.0;
+            frame->labels += drawLabels(cache, &scope, &cached, &bounds, 1, frame);
+        }
+        else if (change == kScopeLayoutTranslated) {
+            cached.originX += dx;
+            cached.originY += dy;
+            nDirty = scopeLayoutDirtyRects(kViewWidth, kViewHeight, dx, dy, bands, 2, dirty);
+            frame->labels += drawLabels(cache, &scope, &cached, dirty, nDirty, frame);
+        }
+
+        frame->seconds += benchNow() - start;
+
+        if (change != kScopeLayoutUnchanged)
+            frame->fullLabels += drawLabels(NULL, &scope, &cached, &bounds, 1, NULL);
+
+        /* Overlapping rects are rasterized twice, so this counts them twice too */
+        for (int i = 0; i < nDirty; i++)
+            frame->dirtyArea += dirty[i].width * dirty[i].height / (kViewWidth * kViewHeight);
+
+        double drift = fmax(fabs((double)cached.originX - state.originX), fabs((double)cached.originY - state.originY));
+        if (drift > maxDrift)
+            maxDrift = drift;
+    }
+
+    printf("Scope label layer, %.0fx%.0f points at %.0fx, %d frames (%d-frame pans and pinches)\n",
+           kViewWidth, kViewHeight, kPixelScale, nFrames, kSegmentFrames);
+    printf("%-8s %8s %11s %13s %12s %15s %12s\n", "gesture", "frames", "redrawn", "dirty area", "misses/frame", "labels (full)", "ns/frame");
+    printStats("pan", &stats[0]);
+    printStats("pinch", &stats[1]);
+    printf("largest cached origin drift %.3f points, %d glyphs live\n", maxDrift, liveGlyphs);
+
+    if (check) {
+
+        const FrameStats *pan = &stats[0];
+
+        if (pan->redraws > 0.05 * pan->frames) {
+            printf("FAIL: %d of %d pan frames re-rasterized\n", pan->redraws, pan->frames);
+            failed = 1;
+        }
+        if (pan->dirtyArea > pan->frames / 2.0) {
+            printf("FAIL: pans dirty %.1f%% of the view per frame\n", 100.0 * pan->dirtyArea / pan->frames);
+            failed = 1;
+        }
+        if (pan->misses > pan->frames) {
+            printf("FAIL: %d glyphs rendered over %d pan frames\n", pan->misses, pan->frames);
+            failed = 1;
+        }
+        if (pan->labels > pan->fullLabels) {
+            printf("FAIL: pans laid out %ld labels where full redraws would lay out %ld\n", pan->labels, pan->fullLabels);
+            failed = 1;
+        }
+        if (maxDrift > 0.5 / kPixelScale + 1e-3) {
+            printf("FAIL: cached origin drifted %.3f points\n", maxDrift);
+            failed = 1;
+        }
+        if (liveGlyphs > kGlyphCacheCapacity) {
+            printf("FAIL: %d glyphs live with a capacity of %d\n", liveGlyphs, kGlyphCacheCapacity);
+            failed = 1;
+        }
+    }
+
+    scopeLabelCacheDestroy(cache);
+
+    if (liveGlyphs != 0) {
+        printf("FAIL: %d glyphs leaked\n", liveGlyphs);
+        failed = 1;
+    }
+
+    return failed;
+}
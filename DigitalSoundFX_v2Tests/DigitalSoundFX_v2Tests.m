@@ -8,27 +8,349 @@
 
 #import <XCTest/XCTest.h>
 
+#import "SampleConversion.h"
+#import "CircularBuffer.h"
+#import "PhaseVocoder.h"
+#import "METScopeView.h"
+#import "ScopeLayout.h"
+
+static const SampleStorageFormat kAllStorageFormats[] = { kSampleStorageFloat32, kSampleStorageInt16, kSampleStorageFloat16 };
+static const int kNumStorageFormats = sizeof(kAllStorageFormats) / sizeof(kAllStorageFormats[0]);
+
+/* Uniform in [-1, 1], repeatable across runs */
+static void fillRandom(float *data, int length, unsigned int seed)
+{
+    for (int i = 0; i < length; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = (seed >> 8) / (float)(1 << 23) - 1.0f;
+    }
+}
+
+static uint16_t packHalf(float x)
+{
+    uint16_t h;
+    packSamplesFloat16(&x, &h, 1);
+    return h;
+}
+
+static float unpackHalf(uint16_t h)
+{
+    float x;
+    unpackSamplesFloat16(&h, &x, 1);
+    return x;
+}
+
 @interface DigitalSoundFX_v2Tests : XCTestCase
 
 @end
 
 @implementation DigitalSoundFX_v2Tests
 
-- (void)setUp
+#pragma mark - Int16
+
+- (void)testInt16ErrorBound
+{
+    const int length = 4099;        // Not a multiple of any vector or block size
+    float in[length], out[length];
+    int16_t packed[length];
+
+    fillRandom(in, length, 1);
+    in[0] = 1.0f;
+    in[1] = -1.0f;
+    in[2] = 0.0f;
+    in[3] = 0.5f / 32767.0f;
+
+    packSamplesInt16(in, packed, length);
+    unpackSamplesInt16(packed, out, length);
+
+    for (int i = 0; i < length; i++)
+        XCTAssertLessThanOrEqual(fabsf(out[i] - in[i]), 0.5f / 32767.0f + 1e-7f, @"sample %d (%g)", i, in[i]);
+
+    XCTAssertEqual(packed[0], (int16_t)32767);
+    XCTAssertEqual(packed[1], (int16_t)-32767);
+    XCTAssertEqual(packed[2], (int16_t)0);
+}
+
+- (void)testInt16Clipping
+{
+    float in[] = { 1.5f, -2.0f, 1.0f + FLT_EPSILON, 100.0f, -INFINITY, INFINITY };
+    const int length = sizeof(in) / sizeof(in[0]);
+    int16_t packed[length];
+    float out[length];
+
+    packSamplesInt16(in, packed, length);
+    unpackSamplesInt16(packed, out, length);
+
+    for (int i = 0; i < length; i++) {
+        XCTAssertEqual(packed[i], (int16_t)(in[i] > 0.0f ? 32767 : -32767), @"sample %d (%g)", i, in[i]);
+        XCTAssertEqual(out[i], in[i] > 0.0f ? 1.0f : -1.0f);
+    }
+}
+
+#pragma mark - Float16
+
+- (void)testFloat16ErrorBound
+{
+    const int length = 4099;
+    float in[length], out[length];
+    uint16_t packed[length];
+
+    fillRandom(in, length, 2);
+
+    packSamplesFloat16(in, packed, length);
+    unpackSamplesFloat16(packed, out, length);
+
+    for (int i = 0; i < length; i++) {
+        float bound = fabsf(in[i]) >= ldexpf(1.0f, -14) ? fabsf(in[i]) * ldexpf(1.0f, -11) : ldexpf(1.0f, -25);
+        XCTAssertLessThanOrEqual(fabsf(out[i] - in[i]), bound, @"sample %d (%g)", i, in[i]);
+    }
+}
+
+- (void)testFloat16RoundToNearestEven
+{
+    const float ulp = ldexpf(1.0f, -10);        // Half precision spacing in [1, 2)
+
+    XCTAssertEqual(packHalf(1.0f), (uint16_t)0x3C00);
+    XCTAssertEqual(packHalf(1.0f + 0.5f * ulp), (uint16_t)0x3C00);                    // Tie, down to even
+    XCTAssertEqual(packHalf(1.0f + 1.5f * ulp), (uint16_t)0x3C02);                    // Tie, up to even
+    XCTAssertEqual(packHalf(1.0f + 0.5f * ulp + ldexpf(1.0f, -20)), (uint16_t)0x3C01); // Just above the tie
+    XCTAssertEqual(packHalf(1.0f + 0.5f * ulp - ldexpf(1.0f, -20)), (uint16_t)0x3C00); // Just below the tie
+    XCTAssertEqual(packHalf(-1.0f - 1.5f * ulp), (uint16_t)0xBC02);
+
+    /* The vector paths convert in groups; check the same ties land identically there */
+    float in[16];
+    uint16_t packed[16];
+    for (int i = 0; i < 16; i++)
+        in[i] = 1.0f + (i + 0.5f) * ulp;
+    packSamplesFloat16(in, packed, 16);
+    for (int i = 0; i < 16; i++)
+        XCTAssertEqual(packed[i], (uint16_t)(0x3C00 + i + (i & 1)), @"tie %d", i);
+}
+
+- (void)testFloat16Subnormals
+{
+    XCTAssertEqual(packHalf(ldexpf(1.0f, -14)), (uint16_t)0x0400);                    // Smallest normal
+    XCTAssertEqual(packHalf(1023.0f * ldexpf(1.0f, -24)), (uint16_t)0x03FF);          // Largest subnormal
+    XCTAssertEqual(packHalf(ldexpf(1.0f, -24)), (uint16_t)0x0001);                    // Smallest subnormal
+    XCTAssertEqual(packHalf(ldexpf(1.0f, -25)), (uint16_t)0x0000);                    // Tie, down to even (zero)
+    XCTAssertEqual(packHalf(3.0f * ldexpf(1.0f, -25)), (uint16_t)0x0002);             // Tie, up to even
+    XCTAssertEqual(packHalf(ldexpf(1.0f, -26)), (uint16_t)0x0000);
+    XCTAssertEqual(packHalf(-ldexpf(1.0f, -24)), (uint16_t)0x8001);
+
+    XCTAssertEqual(unpackHalf(0x0001), ldexpf(1.0f, -24));
+    XCTAssertEqual(unpackHalf(0x03FF), 1023.0f * ldexpf(1.0f, -24));
+    XCTAssertEqual(unpackHalf(0x8200), -ldexpf(1.0f, -15));
+
+    /* Every subnormal half round-trips exactly */
+    for (uint16_t h = 1; h < 0x0400; h++)
+        XCTAssertEqual(packHalf(unpackHalf(h)), h);
+}
+
+- (void)testFloat16Overflow
+{
+    XCTAssertEqual(packHalf(65504.0f), (uint16_t)0x7BFF);                             // Largest finite half
+    XCTAssertEqual(packHalf(65519.0f), (uint16_t)0x7BFF);                             // Below the rounding boundary
+    XCTAssertEqual(packHalf(65520.0f), (uint16_t)0x7C00);                             // Rounds up to inf
+    XCTAssertEqual(packHalf(1.0e6f), (uint16_t)0x7C00);
+    XCTAssertEqual(packHalf(-1.0e6f), (uint16_t)0xFC00);
+    XCTAssertEqual(packHalf(INFINITY), (uint16_t)0x7C00);
+
+    XCTAssertEqual(unpackHalf(0x7C00), INFINITY);
+    XCTAssertEqual(unpackHalf(0xFC00), -INFINITY);
+    XCTAssertTrue(isnan(unpackHalf(packHalf(NAN))));
+}
+
+#pragma mark - CircularBuffer
+
+/* Values the buffer should return for data stored in format */
+static void roundTrip(const float *data, float *expected, int length, SampleStorageFormat format)
+{
+    void *storage = malloc(length * bytesPerSample(format));
+    packSamples(data, storage, 0, length, format);
+    unpackSamples(storage, 0, expected, length, format);
+    free(storage);
+}
+
+- (void)testCircularBufferReadsAcrossWrap
+{
+    float data[14], expected[14], out[10];
+
+    for (int i = 0; i < 14; i++)
+        data[i] = (i + 1) / 16.0f;
+
+    for (int f = 0; f < kNumStorageFormats; f++) {
+
+        SampleStorageFormat format = kAllStorageFormats[f];
+        roundTrip(data, expected, 14, format);
+
+        /* Two writes of 7 into a buffer of 10: the second wraps, leaving the write pointer at 4 */
+        CircularBuffer *buffer = [[CircularBuffer alloc] initWithLength:10 storageFormat:format];
+        [buffer writeDataWithLength:7 inData:data];
+        [buffer writeDataWithLength:7 inData:data + 7];
+
+        XCTAssertEqual([buffer memoryFootprint], 10 * bytesPerSample(format));
+
+        /* Oldest to newest: samples 4-13, split across the end of the storage */
+        [buffer readMostRecentWithLength:10 outData:out];
+        for (int i = 0; i < 10; i++)
+            XCTAssertEqual(out[i], expected[4 + i], @"format %d, most recent sample %d", format, i);
+
+        [buffer readDataFromWritePointerWithLength:10 outData:out];
+        for (int i = 0; i < 10; i++)
+            XCTAssertEqual(out[i], expected[4 + i], @"format %d, write pointer sample %d", format, i);
+
+        /* A shorter read that starts before the wrap and ends after it */
+        [buffer readMostRecentWithLength:6 outData:out];
+        for (int i = 0; i < 6; i++)
+            XCTAssertEqual(out[i], expected[8 + i], @"format %d, short read sample %d", format, i);
+
+        /* Delay tap six samples behind the write pointer reads 8, 9 from the end and 10, 11 from the start */
+        [buffer addDelayTapForSampleDelay:6];
+        [buffer readFromDelayTap:0 withLength:4 outData:out];
+        for (int i = 0; i < 4; i++)
+            XCTAssertEqual(out[i], expected[8 + i], @"format %d, tap sample %d", format, i);
+    }
+}
+
+- (void)testCircularBufferAppendReadPerformance
+{
+    const int length = 2.0 * 44100;
+    const int block = 1024;
+    float *in = (float *)malloc(block * sizeof(float));
+    float *out = (float *)malloc(block * sizeof(float));
+
+    fillRandom(in, block, 3);
+
+    CircularBuffer *buffer = [[CircularBuffer alloc] initWithLength:length storageFormat:kSampleStorageFloat16];
+
+    /* Ten seconds of render callbacks, each appending a block and reading back the most recent one */
+    [self measureBlock:^{
+        for (int i = 0; i < 10 * 44100 / block; i++) {
+            [buffer writeDataWithLength:block inData:in];
+            [buffer readMostRecentWithLength:block outData:out];
+        }
+    }];
+
+    free(in);
+    free(out);
+}
+
+#pragma mark - PhaseVocoder
+
+static void fillSine(float *data, int length, double frequency)
 {
-    [super setUp];
-    // Put setup code here. This method is called before the invocation of each test method in the class.
+    for (int i = 0; i < length; i++)
+        data[i] = 0.5 * sin(2.0 * M_PI * frequency * i / 44100.0);
 }
 
-- (void)tearDown
+/* Level relative to fillSine()'s, dB */
+static double sineLevelDB(const float *data, int length)
 {
-    // Put teardown code here. This method is called after the invocation of each test method in the class.
-    [super tearDown];
+    double sum = 0.0;
+    for (int i = 0; i < length; i++)
+        sum += (double)data[i] * data[i];
+
+    return 20.0 * log10(sqrt(sum / length) / (0.5 * M_SQRT1_2));
 }
 
-- (void)testExample
+- (void)testPitchShiftPreservesLevel
 {
-    XCTFail(@"No implementation for \"%s\"", __PRETTY_FUNCTION__);
+    const float ratios[] = { 0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 2.0f };
+    const int length = 2 * 44100;
+    float *data = (float *)malloc(length * sizeof(float));
+
+    for (int r = 0; r < (int)(sizeof(ratios) / sizeof(ratios[0])); r++) {
+
+        PhaseVocoder *pv = phaseVocoderCreate(kPhaseVocoderDefaultFFTSize, kPhaseVocoderDefaultOverlap);
+        phaseVocoderSetPitchRatio(pv, ratios[r]);
+
+        fillSine(data, length, 440.0);
+        for (int i = 0; i < length; i += 512)
+            phaseVocoderProcess(pv, data + i, MIN(512, length - i));
+
+        int start = phaseVocoderGetLatency(pv) + 2 * kPhaseVocoderDefaultFFTSize;
+        phaseVocoderDestroy(pv);
+
+        XCTAssertEqualWithAccuracy(sineLevelDB(data + start, length - start), 0.0, 0.5, @"ratio %g", ratios[r]);
+    }
+
+    free(data);
+}
+
+- (void)testTimeStretchPreservesLevel
+{
+    const float stretches[] = { 0.5f, 0.75f, 1.5f, 2.0f, 3.0f };
+    const int length = 2 * 44100;
+    float *in = (float *)malloc(length * sizeof(float));
+    float *out = (float *)malloc(3 * length * sizeof(float));
+
+    fillSine(in, length, 440.0);
+
+    for (int s = 0; s < (int)(sizeof(stretches) / sizeof(stretches[0])); s++) {
+
+        int n = phaseVocoderTimeStretch(in, length, out, 3 * length, stretches[s],
+                                        kPhaseVocoderDefaultFFTSize, kPhaseVocoderDefaultOverlap, 0);
+        XCTAssertEqual(n, (int)(length * stretches[s] + 0.5f));
+
+        /* Skip the edges, which overlap-add with the zero padding */
+        int edge = 2 * kPhaseVocoderDefaultFFTSize;
+        XCTAssertEqualWithAccuracy(sineLevelDB(out + edge, n - 2 * edge), 0.0, 0.5, @"stretch %g", stretches[s]);
+    }
+
+    free(in);
+    free(out);
+}
+
+#pragma mark - ScopeLayout
+
+- (void)testTicksWithFarOffscreenOriginAreEmpty
+{
+    ScopeTicks ticks;
+
+    scopeTicksCompute(&ticks, 1e12f, 0.001f, 0, 700);
+    XCTAssertEqual(ticks.nTicks, 0);
+
+    scopeTicksCompute(&ticks, -3e9f, 1.0f, 0, 700);
+    XCTAssertEqual(ticks.nTicks, 0);
+
+    scopeTicksCompute(&ticks, 100.0f, 50.0f, 0, 700);
+    XCTAssertEqual(ticks.nTicks, 15);
+    XCTAssertEqual(ticks.index[0], -2);
+}
+
+- (void)testDirtyRectsMergeShiftedBands
+{
+    ScopeRect bands[2] = { { 0, 273, 700, 27 }, { 0, 0, 40, 300 } };
+    ScopeRect dirty[kScopeMaxDirtyRects];
+
+    /* Each band and its shifted copy overlap, and both exposed edges lie inside a band */
+    int n = scopeLayoutDirtyRects(700, 300, 1.5f, -1.0f, bands, 2, dirty);
+    XCTAssertEqual(n, 2);
+    XCTAssertEqual(dirty[0].y, 272.0f);
+    XCTAssertEqual(dirty[0].height, 28.0f);
+    XCTAssertEqual(dirty[1].width, 41.5f);
+
+    /* The right edge isn't covered */
+    n = scopeLayoutDirtyRects(700, 300, -1.5f, 0.0f, bands, 2, dirty);
+    XCTAssertEqual(n, 3);
+    XCTAssertEqual(dirty[2].x, 698.5f);
+}
+
+#pragma mark - METScopeView
+
+- (void)testGridAutoScaleIsStableWhilePanning
+{
+    METScopeView *scope = [[METScopeView alloc] initWithFrame:CGRectMake(0, 0, 700, 300)];
+    [scope setXGridAutoScale:true];
+
+    /* 0.005 gives 3.7 ticks in frame, and a step down rounds to 0.003, giving 6.1 */
+    [scope setVisibleXLim:0.0 max:0.0184];
+    float tick = scope.tickUnits.x;
+
+    for (int i = 1; i <= 10; i++) {
+        [scope setVisibleXLim:0.0001 * i max:0.0184 + 0.0001 * i];
+        XCTAssertEqual((float)scope.tickUnits.x, tick, @"pan %d", i);
+    }
 }
 
 @end
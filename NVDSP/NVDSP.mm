@@ -9,6 +9,7 @@
 //
 
 #import "NVDSP.h"
+#import "Denormals.h"
 
 #define MAX_CHANNEL_COUNT 2
 
@@ -82,6 +83,10 @@
     memcpy(gInputKeepBuffer[channel], &(tInputBuffer[numFrames]), 2 * sizeof(float));
     memcpy(gOutputKeepBuffer[channel], &(tOutputBuffer[numFrames]), 2 * sizeof(float));
     
+    // Keep the recursive state out of the subnormal range once the input goes quiet
+    flushDenormals(gInputKeepBuffer[channel], 2);
+    flushDenormals(gOutputKeepBuffer[channel], 2);
+    
     free(tInputBuffer);
     free(tOutputBuffer);
 }
@@ -12,21 +12,31 @@
 
 #import <Foundation/Foundation.h>
 
+#import "SampleConversion.h"
+
 #define kMaxNumDelayTaps 5
 
 @interface CircularBuffer : NSObject {
     
-    Float32 *buffer;
+    void *buffer;           // Samples stored in storageFormat
     int bufferLength;
     int writeIdx;
     int delayTaps[kMaxNumDelayTaps];
 }
 
 @property (readonly) int nTaps;
+@property (readonly) int length;
+@property (readonly) SampleStorageFormat storageFormat;
 
-/* Allocate the buffer with a specified length */
+/* Allocate the buffer with a specified length (Float32 storage) */
 - (id)initWithLength:(int)length;
 
+/* Allocate the buffer with a specified length and compact storage format (see SampleConversion.h for accuracy) */
+- (id)initWithLength:(int)length storageFormat:(SampleStorageFormat)format;
+
+/* Bytes allocated for sample storage */
+- (size_t)memoryFootprint;
+
 /* Add a new delay tap */
 - (void)addDelayTapForSampleDelay:(int)nSamples;
 
@@ -40,6 +50,9 @@
 /* Read data starting from the write pointer without changing read/write pointers */
 - (void)readDataFromWritePointerWithLength:(int)length outData:(Float32 *)data;
 
+/* Read the most recent length samples (ending at the write pointer) without changing read/write pointers */
+- (void)readMostRecentWithLength:(int)length outData:(Float32 *)data;
+
 /* Read data starting from the delay tap index*/
 - (void)readFromDelayTap:(int)tapIdx withLength:(int)length outData:(Float32 *)data;
 
@@ -11,18 +11,27 @@
 @implementation CircularBuffer
 
 @synthesize nTaps;
+@synthesize length = bufferLength;
+@synthesize storageFormat;
 
 /* Allocate the buffer with a specified length */
 - (id)initWithLength:(int)length {
     
+    return [self initWithLength:length storageFormat:kSampleStorageFloat32];
+}
+
+/* Allocate the buffer with a specified length and storage format */
+- (id)initWithLength:(int)length storageFormat:(SampleStorageFormat)format {
+    
     self = [super init];
     if (self) {
     
         if (buffer)
             free(buffer);
         
+        storageFormat = format;
         bufferLength = length;
-        buffer = (Float32 *)calloc(bufferLength, sizeof(Float32));
+        buffer = calloc(bufferLength, bytesPerSample(storageFormat));
         writeIdx = 0;
         nTaps = 0;
     }
@@ -30,6 +39,18 @@
     return self;
 }
 
+- (void)dealloc {
+    
+    if (buffer)
+        free(buffer);
+}
+
+/* Bytes allocated for sample storage */
+- (size_t)memoryFootprint {
+    
+    return bufferLength * bytesPerSample(storageFormat);
+}
+
 /* Add a new delay tap */
 - (void)addDelayTapForSampleDelay:(int)nSamples {
     
@@ -76,29 +97,28 @@
 /* Write data to the circular buffer */
 - (void)writeDataWithLength:(int)length inData:(Float32 *)data {
     
-    for (int i = 0; i < length; i++) {
-        
-        buffer[writeIdx] = data[i];
-        
-        writeIdx++;
-        if (writeIdx >= bufferLength)
-            writeIdx = 0;
-    }
+    writeIdx = packSamplesRing(data, buffer, bufferLength, writeIdx, length, storageFormat);
 }
 
 /* Read data starting from the write pointer without changing read/write pointers */
 - (void)readDataFromWritePointerWithLength:(int)length outData:(Float32 *)data {
     
-    int writeIdxCopy = writeIdx;
+    unpackSamplesRing(buffer, bufferLength, writeIdx, data, length, storageFormat);
+}
+
+/* Read the most recent length samples (ending at the write pointer) without changing read/write pointers */
+- (void)readMostRecentWithLength:(int)length outData:(Float32 *)data {
     
-    for (int i = 0; i < length; i++) {
-        
-        data[i] = buffer[writeIdxCopy];
-        
-        writeIdxCopy++;
-        if (writeIdxCopy >= bufferLength)
-            writeIdxCopy = 0;
+    if (length > bufferLength) {
+        NSLog(@"Warning: Requested %d samples from buffer of length %d", length, bufferLength);
+        length = bufferLength;
     }
+    
+    int readIdx = writeIdx - length;
+    if (readIdx < 0)
+        readIdx += bufferLength;
+    
+    unpackSamplesRing(buffer, bufferLength, readIdx, data, length, storageFormat);
 }
 
 /* Read data starting from the delay tap index*/
@@ -109,14 +129,7 @@
         return;
     }
     
-    for (int i = 0; i < length; i++) {
-        
-        data[i] = buffer[delayTaps[tapIdx]];
-        
-        delayTaps[tapIdx]++;
-        if (delayTaps[tapIdx] >= bufferLength)
-            delayTaps[tapIdx] = 0;
-    }
+    delayTaps[tapIdx] = unpackSamplesRing(buffer, bufferLength, delayTaps[tapIdx], data, length, storageFormat);
 }
 
 @end
@@ -0,0 +1,57 @@
+//
+//  Denormals.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+#include "Denormals.h"
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define kMXCSRFlushToZero       0x8000
+#define kMXCSRDenormalsAreZero  0x0040
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__VFP_FP__) && !defined(__SOFTFP__))
+#define kFPCRFlushToZero        (1u << 24)
+#endif
+
+DenormalMode denormalsDisable(void) {
+
+#if defined(kMXCSRFlushToZero)
+    unsigned int csr = _mm_getcsr();
+    _mm_setcsr(csr | kMXCSRFlushToZero | kMXCSRDenormalsAreZero);
+    return csr;
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | kFPCRFlushToZero));
+    return fpcr;
+#elif defined(kFPCRFlushToZero)
+    uint32_t fpscr;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"(fpscr | kFPCRFlushToZero));
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+void denormalsRestore(DenormalMode mode) {
+
+#if defined(kMXCSRFlushToZero)
+    _mm_setcsr((unsigned int)mode);
+#elif defined(__aarch64__)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(mode));
+#elif defined(kFPCRFlushToZero)
+    __asm__ __volatile__("vmsr fpscr, %0" : : "r"((uint32_t)mode));
+#else
+    (void)mode;
+#endif
+}
+
+void flushDenormals(float *data, int length) {
+
+    for (int i = 0; i < length; i++)
+        data[i] = flushDenormal(data[i]);
+}
@@ -0,0 +1,50 @@
+//
+//  Denormals.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Denormal (subnormal) protection. Recursive state (biquad feedback, delay lines) decaying toward zero after the input goes silent passes through the subnormal range, where arithmetic is many times slower on x86 and on VFP without flush-to-zero.
+
+    denormalsDisable()/denormalsRestore() bracket the render callback: they set flush-to-zero (and denormals-are-zero on SSE) for the calling thread only and put the previous mode back, so other threads are unaffected. On targets without a flush-to-zero control they do nothing.
+
+    The flushDenormal()/flushDenormals() calls on filter and delay state run unconditionally, whether or not the mode could be set. They cost a compare per state variable and keep recursive state at exact zero, so protection doesn't depend on every caller getting the mode right. Benchmarks/DenormalsBench measures each protection on its own.
+ */
+
+#ifndef DigitalSoundFX_Denormals_h
+#define DigitalSoundFX_Denormals_h
+
+#include <stdint.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Magnitudes below this (~-300 dB) are treated as zero. Well above the largest subnormal (~1.18e-38) so state flushed here never gets there */
+#define kDenormalThreshold 1e-15f
+
+/* Saved floating point control register */
+typedef uint64_t DenormalMode;
+
+/* Enable flush-to-zero for the calling thread, returning the previous mode */
+DenormalMode denormalsDisable(void);
+
+/* Restore the mode returned by denormalsDisable() */
+void denormalsRestore(DenormalMode mode);
+
+static inline float flushDenormal(float x) {
+    return (fabsf(x) < kDenormalThreshold) ? 0.0f : x;
+}
+
+/* Zero every sample below kDenormalThreshold in place */
+void flushDenormals(float *data, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
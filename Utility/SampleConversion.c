@@ -0,0 +1,342 @@
+//
+//  SampleConversion.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+#include "SampleConversion.h"
+
+#include <string.h>
+
+#ifdef __APPLE__
+#include <Accelerate/Accelerate.h>
+#endif
+
+#include <math.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SampleConversion_NEON 1
+#if defined(__ARM_FP) && (__ARM_FP & 2)
+#define SampleConversion_NEON_FP16 1
+#endif
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SampleConversion_SSE2 1
+#if defined(__F16C__)
+#include <immintrin.h>
+#define SampleConversion_F16C 1
+#endif
+#endif
+
+/* Samples converted per block when a scratch buffer is needed */
+#define kConversionBlockSize 256
+
+#define kInt16FullScale 32767.0f
+
+const char *sampleConversionKernels(void) {
+
+#if defined(__APPLE__) && defined(SampleConversion_NEON_FP16)
+    return "vDSP, NEON FP16";
+#elif defined(__APPLE__) && defined(SampleConversion_F16C)
+    return "vDSP, F16C";
+#elif defined(__APPLE__)
+    return "vDSP, scalar Float16";
+#elif defined(SampleConversion_NEON_FP16)
+    return "NEON, NEON FP16";
+#elif defined(SampleConversion_NEON)
+    return "NEON, scalar Float16";
+#elif defined(SampleConversion_F16C)
+    return "SSE2, F16C";
+#elif defined(SampleConversion_SSE2)
+    return "SSE2, scalar Float16";
+#else
+    return "scalar";
+#endif
+}
+
+size_t bytesPerSample(SampleStorageFormat format) {
+
+    switch (format) {
+        case kSampleStorageInt16:
+        case kSampleStorageFloat16:
+            return 2;
+        case kSampleStorageFloat32:
+        default:
+            return sizeof(float);
+    }
+}
+
+/* == Int16 == */
+
+void packSamplesInt16(const float *inData, int16_t *outData, int length) {
+
+#ifdef __APPLE__
+    float scratch[kConversionBlockSize];
+    float low = -1.0f, high = 1.0f, fullScale = kInt16FullScale;
+
+    /* Clip, scale, and round to the nearest integer in blocks */
+    for (int i = 0; i < length; i += kConversionBlockSize) {
+
+        vDSP_Length n = (length - i < kConversionBlockSize) ? length - i : kConversionBlockSize;
+        vDSP_vclip(inData + i, 1, &low, &high, scratch, 1, n);
+        vDSP_vsmul(scratch, 1, &fullScale, scratch, 1, n);
+        vDSP_vfixr16(scratch, 1, outData + i, 1, n);
+    }
+#else
+    const float fullScale = kInt16FullScale;
+    int i = 0;
+
+    /* Clip, scale, round to nearest and narrow, eight samples at a time. Autovectorizers don't turn the rounding into a vector conversion, so it's spelled out */
+#if defined(SampleConversion_SSE2)
+    const __m128 low = _mm_set1_ps(-1.0f), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(fullScale);
+    for (; i + 8 <= length; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(inData + i), high), low), scale);
+        __m128 b = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(inData + i + 4), high), low), scale);
+        _mm_storeu_si128((__m128i *)(outData + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif defined(SampleConversion_NEON)
+    const float32x4_t low = vdupq_n_f32(-1.0f), high = vdupq_n_f32(1.0f);
+    for (; i + 8 <= length; i += 8) {
+        float32x4_t a = vmulq_n_f32(vmaxq_f32(vminq_f32(vld1q_f32(inData + i), high), low), fullScale);
+        float32x4_t b = vmulq_n_f32(vmaxq_f32(vminq_f32(vld1q_f32(inData + i + 4), high), low), fullScale);
+#if defined(__aarch64__)
+        int32x4_t ia = vcvtnq_s32_f32(a), ib = vcvtnq_s32_f32(b);
+#else
+        /* ARMv7 only converts with truncation: add +/-0.5 first (rounds halves away from zero) */
+        const uint32x4_t signBit = vdupq_n_u32(0x80000000u), half = vreinterpretq_u32_f32(vdupq_n_f32(0.5f));
+        int32x4_t ia = vcvtq_s32_f32(vaddq_f32(a, vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(a), signBit), half))));
+        int32x4_t ib = vcvtq_s32_f32(vaddq_f32(b, vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(b), signBit), half))));
+#endif
+        vst1q_s16(outData + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+#endif
+
+    for (; i < length; i++) {
+        float x = inData[i];
+        x = x > 1.0f ? 1.0f : (x >= -1.0f ? x : -1.0f);
+        outData[i] = (int16_t)lrintf(x * fullScale);
+    }
+#endif
+}
+
+void unpackSamplesInt16(const int16_t *inData, float *outData, int length) {
+
+#ifdef __APPLE__
+    float scale = 1.0f / kInt16FullScale;
+    vDSP_vflt16(inData, 1, outData, 1, length);
+    vDSP_vsmul(outData, 1, &scale, outData, 1, length);
+#else
+    const float scale = 1.0f / kInt16FullScale;
+    int i = 0;
+
+#if defined(SampleConversion_SSE2)
+    const __m128 vScale = _mm_set1_ps(scale);
+    for (; i + 8 <= length; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(inData + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(h, h), 16);      // Sign-extend
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(h, h), 16);
+        _mm_storeu_ps(outData + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vScale));
+        _mm_storeu_ps(outData + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vScale));
+    }
+#elif defined(SampleConversion_NEON)
+    for (; i + 8 <= length; i += 8) {
+        int16x8_t h = vld1q_s16(inData + i);
+        vst1q_f32(outData + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(h))), scale));
+        vst1q_f32(outData + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(h))), scale));
+    }
+#endif
+
+    for (; i < length; i++)
+        outData[i] = (float)inData[i] * scale;
+#endif
+}
+
+/* == Float16 == */
+
+/* Scalar fallbacks, round to nearest even */
+static inline uint16_t floatToHalf(float f) {
+
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    uint16_t sign = (x >> 16) & 0x8000;
+    uint32_t absX = x & 0x7FFFFFFF;
+
+    /* NaN/inf */
+    if (absX >= 0x7F800000)
+        return sign | 0x7C00 | (absX > 0x7F800000 ? 0x0200 : 0);
+
+    /* Overflow to inf */
+    if (absX >= 0x477FF000)
+        return sign | 0x7C00;
+
+    /* Subnormal half (or zero) */
+    if (absX < 0x38800000) {
+
+        if (absX < 0x33000000)
+            return sign;
+
+        uint32_t mantissa = (absX & 0x007FFFFF) | 0x00800000;
+        int shift = 126 - (int)(absX >> 23);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+            half++;
+        return sign | (uint16_t)half;
+    }
+
+    /* Normal: rebias exponent, round mantissa from 23 to 10 bits */
+    uint32_t half = ((absX - 0x38000000) >> 13);
+    uint32_t remainder = absX & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        half++;
+
+    return sign | (uint16_t)half;
+}
+
+static inline float halfToFloat(uint16_t h) {
+
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x03FF;
+    uint32_t x;
+
+    if (exponent == 0x1F)
+        x = sign | 0x7F800000 | (mantissa << 13);
+
+    else if (exponent == 0) {
+
+        if (mantissa == 0)
+            x = sign;
+
+        /* Normalize the subnormal half */
+        else {
+            exponent = 113;
+            while (!(mantissa & 0x0400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            x = sign | (exponent << 23) | ((mantissa & 0x03FF) << 13);
+        }
+    }
+    else
+        x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+void packSamplesFloat16(const float *inData, uint16_t *outData, int length) {
+
+    int i = 0;
+
+#if defined(SampleConversion_NEON_FP16)
+    for (; i + 4 <= length; i += 4)
+        vst1_u16(outData + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(inData + i))));
+#elif defined(SampleConversion_F16C)
+    for (; i + 8 <= length; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(inData + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(outData + i), h);
+    }
+#endif
+
+    for (; i < length; i++)
+        outData[i] = floatToHalf(inData[i]);
+}
+
+void unpackSamplesFloat16(const uint16_t *inData, float *outData, int length) {
+
+    int i = 0;
+
+#if defined(SampleConversion_NEON_FP16)
+    for (; i + 4 <= length; i += 4)
+        vst1q_f32(outData + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(inData + i))));
+#elif defined(SampleConversion_F16C)
+    for (; i + 8 <= length; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(inData + i));
+        _mm256_storeu_ps(outData + i, _mm256_cvtph_ps(h));
+    }
+#endif
+
+    for (; i < length; i++)
+        outData[i] = halfToFloat(inData[i]);
+}
+
+/* == Generic == */
+
+void packSamples(const float *inData, void *storage, int offset, int length, SampleStorageFormat format) {
+
+    switch (format) {
+        case kSampleStorageInt16:
+            packSamplesInt16(inData, (int16_t *)storage + offset, length);
+            break;
+        case kSampleStorageFloat16:
+            packSamplesFloat16(inData, (uint16_t *)storage + offset, length);
+            break;
+        case kSampleStorageFloat32:
+        default:
+            memcpy((float *)storage + offset, inData, length * sizeof(float));
+            break;
+    }
+}
+
+void unpackSamples(const void *storage, int offset, float *outData, int length, SampleStorageFormat format) {
+
+    switch (format) {
+        case kSampleStorageInt16:
+            unpackSamplesInt16((const int16_t *)storage + offset, outData, length);
+            break;
+        case kSampleStorageFloat16:
+            unpackSamplesFloat16((const uint16_t *)storage + offset, outData, length);
+            break;
+        case kSampleStorageFloat32:
+        default:
+            memcpy(outData, (const float *)storage + offset, length * sizeof(float));
+            break;
+    }
+}
+
+int packSamplesRing(const float *inData, void *storage, int ringLength, int index, int length, SampleStorageFormat format) {
+
+    if (index >= ringLength)
+        index = 0;
+
+    while (length > 0) {
+
+        int n = (length < ringLength - index) ? length : ringLength - index;
+        packSamples(inData, storage, index, n, format);
+
+        inData += n;
+        length -= n;
+        index += n;
+        if (index >= ringLength)
+            index = 0;
+    }
+
+    return index;
+}
+
+int unpackSamplesRing(const void *storage, int ringLength, int index, float *outData, int length, SampleStorageFormat format) {
+
+    if (index >= ringLength)
+        index = 0;
+
+    while (length > 0) {
+
+        int n = (length < ringLength - index) ? length : ringLength - index;
+        unpackSamples(storage, index, outData, n, format);
+
+        outData += n;
+        length -= n;
+        index += n;
+        if (index >= ringLength)
+            index = 0;
+    }
+
+    return index;
+}
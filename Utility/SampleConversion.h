@@ -0,0 +1,62 @@
+//
+//  SampleConversion.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Pack/unpack kernels for storing Float32 audio in compact formats. Used by CircularBuffer (through the ring functions) for the delay line and the scope display histories.
+
+    Accuracy bounds (for input in [-1, 1]):
+
+        kSampleStorageFloat32:  exact
+        kSampleStorageInt16:    |error| <= 0.5 / 32767 (~1.53e-5, ~96 dB SNR). Input is clipped to [-1, 1]
+        kSampleStorageFloat16:  |error| <= |x| * 2^-11 for |x| >= 2^-14, <= 2^-25 below that (subnormal halves).
+                                Range +/-65504; larger values become +/-inf
+ */
+
+#ifndef DigitalSoundFX_SampleConversion_h
+#define DigitalSoundFX_SampleConversion_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum SampleStorageFormat {
+    kSampleStorageFloat32,
+    kSampleStorageInt16,
+    kSampleStorageFloat16
+} SampleStorageFormat;
+
+/* Vector kernels compiled in (e.g. "SSE2, F16C"), for benchmark and diagnostic output */
+const char *sampleConversionKernels(void);
+
+/* Bytes used to store one sample in the specified format */
+size_t bytesPerSample(SampleStorageFormat format);
+
+/* Float32 <-> Int16, full scale +/-1.0 <-> +/-32767 */
+void packSamplesInt16(const float *inData, int16_t *outData, int length);
+void unpackSamplesInt16(const int16_t *inData, float *outData, int length);
+
+/* Float32 <-> IEEE 754 half precision (round to nearest even) */
+void packSamplesFloat16(const float *inData, uint16_t *outData, int length);
+void unpackSamplesFloat16(const uint16_t *inData, float *outData, int length);
+
+/* Convert length samples to/from storage starting at sample index offset */
+void packSamples(const float *inData, void *storage, int offset, int length, SampleStorageFormat format);
+void unpackSamples(const void *storage, int offset, float *outData, int length, SampleStorageFormat format);
+
+/* Convert length samples to/from a ring of ringLength samples starting at index, in contiguous segments that wrap at the end of the ring. Returns the index following the last sample */
+int packSamplesRing(const float *inData, void *storage, int ringLength, int index, int length, SampleStorageFormat format);
+int unpackSamplesRing(const void *storage, int ringLength, int index, float *outData, int length, SampleStorageFormat format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -7,15 +7,29 @@
 //
 
 #import "METScopeView.h"
+#import "ScopeLayout.h"
+
+/* Single-precision plot coordinates (CGPoint is double-precision on 64-bit), halving the footprint of the plot data arrays */
+typedef struct METScopePoint {
+    float x;
+    float y;
+} METScopePoint;
+
+static inline METScopePoint METScopePointMake(float x, float y) {
+    METScopePoint p;
+    p.x = x;
+    p.y = y;
+    return p;
+}
 
 #pragma mark -
 #pragma mark METScopePlotDataView
 @interface METScopePlotDataView : UIView {
-    CGPoint *plotUnits;     // Plot data in plot units
-    CGPoint *plotPixels;    // Plot data in pixels
+    METScopePoint *plotUnits;   // Plot data in plot units
+    METScopePoint *plotPixels;  // Plot data in pixels
     pthread_mutex_t dataMutex;
 }
-@property (readonly) CGPoint *plotUnits;
+@property (readonly) METScopePoint *plotUnits;
 @property (readonly) METScopeView *parent;
 @property (readonly) bool visible;
 @property (readonly) int resolution;
@@ -89,8 +103,8 @@
     if (plotPixels)
         free(plotPixels);
     
-    plotUnits  = (CGPoint *)calloc(resolution, sizeof(CGPoint));
-    plotPixels = (CGPoint *)calloc(resolution, sizeof(CGPoint));
+    plotUnits  = (METScopePoint *)calloc(resolution, sizeof(METScopePoint));
+    plotPixels = (METScopePoint *)calloc(resolution, sizeof(METScopePoint));
     
     pthread_mutex_unlock(&dataMutex);
 }
@@ -142,7 +156,7 @@
             /* Copy the data */
             pthread_mutex_lock(&dataMutex);
             for (int i = 0; i < resolution; i++)
-                plotUnits[i] = CGPointMake(amplitudeXBuffer[i], maxAmpYBuffer[i]);
+                plotUnits[i] = METScopePointMake(amplitudeXBuffer[i], maxAmpYBuffer[i]);
             pthread_mutex_unlock(&dataMutex);
             
             free(amplitudeXBuffer);
@@ -162,7 +176,7 @@
             int idx;
             for (int i = 0; i < resolution; i++) {
                 idx = (int)indices[i];
-                plotUnits[i] = CGPointMake(xBuffer[idx], yBuffer[idx]);
+                plotUnits[i] = METScopePointMake(xBuffer[idx], yBuffer[idx]);
             }
             
             pthread_mutex_unlock(&dataMutex);
@@ -181,7 +195,7 @@
         pthread_mutex_lock(&dataMutex);
         
         /* Interpolate */
-        CGPoint current, next, target;
+        METScopePoint current, next, target;
         float perc;
         int j = 0;
         for (int i = 0; i < length-1; i++) {
@@ -222,7 +236,7 @@
     else {
         pthread_mutex_lock(&dataMutex);
         for (int i = 0; i < length; i++)
-            plotUnits[i] = CGPointMake(xBuffer[i], yBuffer[i]);
+            plotUnits[i] = METScopePointMake(xBuffer[i], yBuffer[i]);
         pthread_mutex_unlock(&dataMutex);
     }
     
@@ -237,8 +251,11 @@
     
     pthread_mutex_lock(&dataMutex);
     
-    for (int i = 0; i < resolution; i++)
-        plotPixels[i] = [parent plotScaleToPixel:plotUnits[i]];
+    CGPoint pixel;
+    for (int i = 0; i < resolution; i++) {
+        pixel = [parent plotScaleToPixel:plotUnits[i].x y:plotUnits[i].y];
+        plotPixels[i] = METScopePointMake(pixel.x, pixel.y);
+    }
     
     pthread_mutex_unlock(&dataMutex);
     
@@ -279,13 +296,13 @@
     if (fillMode) {
         
         CGPoint current;
-        CGPoint previous = plotPixels[0];
+        CGPoint previous = CGPointMake(plotPixels[0].x, plotPixels[0].y);
         for (int i = 1; i < resolution-1; i++) {
             
             if (isnan((float)plotPixels[i].x) || isnan((float)plotPixels[i].y))
                 continue;
             
-            current = plotPixels[i];
+            current = CGPointMake(plotPixels[i].x, plotPixels[i].y);
             
             UIBezierPath *path = [UIBezierPath bezierPath];
             [path moveToPoint:previous];
@@ -301,7 +318,7 @@
             [path fill];
             [path stroke];
             
-            previous = plotPixels[i];
+            previous = CGPointMake(plotPixels[i].x, plotPixels[i].y);
         }
     }
     
@@ -311,7 +328,7 @@
         CGContextSetLineWidth(context, lineWidth);
         CGContextSetStrokeColorWithColor(context, lineColor.CGColor);
         
-        CGPoint previous = plotPixels[0];
+        METScopePoint previous = plotPixels[0];
         for (int i = 2; i < resolution-1; i++) {
             
             if (isnan((float)plotPixels[i].x) || isnan((float)plotPixels[i].y))
@@ -342,12 +359,24 @@
 @end
 
 #pragma mark -
-#pragma mark METScopeAxisView
-@interface METScopeAxisView : UIView
+#pragma mark METScopeCachedLayerView
+/* Base class for the axis, grid and label subviews. Renders into an offscreen bitmap handed to the layer as its contents, so redisplaying an unchanged layer costs nothing. On a pan the bitmap is shifted and only the exposed edges (and any fixed bands) are redrawn; it's only re-rasterized when the tick spacing, axis scale or style changes (see ScopeLayout.h) */
+@interface METScopeCachedLayerView : UIView {
+    CGContextRef cacheContext;      // Offscreen bitmap, flipped to view coordinates
+    CGImageRef cacheImage;          // Snapshot of cacheContext set as the layer contents
+    CGFloat cacheScale;             // Device pixels per point of the bitmap
+    ScopeLayoutState cachedState;   // State the cache was drawn from (origin aligned to device pixels)
+    bool cacheValid;
+}
 @property METScopeView *parent;
+- (id)initWithParentView:(METScopeView *)parentView;
+- (ScopeLayoutState)currentLayoutState;
+- (int)getFixedBands:(ScopeRect *)bands;
+- (void)drawLayerWithState:(const ScopeLayoutState *)state inContext:(CGContextRef)context dirtyRect:(CGRect)dirty;
+- (void)redrawCacheRects:(const CGRect *)rects count:(int)count;
 @end
 
-@implementation METScopeAxisView
+@implementation METScopeCachedLayerView
 @synthesize parent;
 
 /* Create a transparent subview using the parent's frame */
@@ -355,21 +384,195 @@
     
     CGRect frame = parentView.frame;
     frame.origin.x = frame.origin.y = 0;
-
+    
     self = [super initWithFrame:frame];
-
+    
     if (self) {
         [self setBackgroundColor:[UIColor clearColor]];
         parent = parentView;
+        cacheValid = false;
     }
     return self;
 }
 
-/* Draw axes */
-- (void)drawRect:(CGRect)rect {
+- (void)dealloc {
+    
+    CGImageRelease(cacheImage);
+    CGContextRelease(cacheContext);
+}
+
+/* The parent's origin and tick spacing in this view's coordinates. Subclasses add anything else they depend on to the style hash */
+- (ScopeLayoutState)currentLayoutState {
+    
+    ScopeLayoutState state;
+    memset(&state, 0, sizeof(ScopeLayoutState));
+    
+    state.width = self.bounds.size.width;
+    state.height = self.bounds.size.height;
+    state.originX = parent.originPixel.x - self.frame.origin.x;
+    state.originY = parent.originPixel.y - self.frame.origin.y;
+    state.tickPixelsX = parent.tickPixels.x;
+    state.tickPixelsY = parent.tickPixels.y;
+    state.tickUnitsX = parent.tickUnits.x;
+    state.tickUnitsY = parent.tickUnits.y;
+    state.axisScale = parent.axisScale;
     
-    CGContextRef context = UIGraphicsGetCurrentContext();
-    CGPoint loc;            // Reusable current location
+    return state;
+}
+
+/* Regions whose content doesn't move with the plot origin */
+- (int)getFixedBands:(ScopeRect *)bands {
+    return 0;
+}
+
+/* Subclasses draw their content within the dirty rect (the context is already clipped to it) */
+- (void)drawLayerWithState:(const ScopeLayoutState *)state inContext:(CGContextRef)context dirtyRect:(CGRect)dirty {
+}
+
+/* Hand the cached bitmap to the layer instead of drawing it in drawRect */
+- (void)displayLayer:(CALayer *)layer {
+    
+    [self updateCache];
+    
+    layer.contentsScale = cacheScale;
+    layer.contents = (__bridge id)cacheImage;
+}
+
+- (bool)allocateCacheWithState:(const ScopeLayoutState *)state scale:(CGFloat)scale {
+    
+    size_t pixelsWide = (size_t)ceil(state->width * scale);
+    size_t pixelsHigh = (size_t)ceil(state->height * scale);
+    
+    if (pixelsWide == 0 || pixelsHigh == 0)
+        return false;
+    
+    if (cacheContext && scale == cacheScale && CGBitmapContextGetWidth(cacheContext) == pixelsWide &&
+        CGBitmapContextGetHeight(cacheContext) == pixelsHigh)
+        return true;
+    
+    CGContextRelease(cacheContext);
+    
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    cacheContext = CGBitmapContextCreate(NULL, pixelsWide, pixelsHigh, 8, 0, colorSpace,
+                                         kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    
+    if (!cacheContext)
+        return false;
+    
+    /* Flip to UIKit's top-left origin and scale to points */
+    CGContextTranslateCTM(cacheContext, 0, pixelsHigh);
+    CGContextScaleCTM(cacheContext, scale, -scale);
+    CGContextSetInterpolationQuality(cacheContext, kCGInterpolationNone);
+    
+    return true;
+}
+
+/* Clear and redraw a region of the cache from the cached state */
+- (void)redrawCacheRect:(CGRect)dirty {
+    
+    CGContextSaveGState(cacheContext);
+    CGContextClipToRect(cacheContext, dirty);
+    CGContextClearRect(cacheContext, dirty);
+    [self drawLayerWithState:&cachedState inContext:cacheContext dirtyRect:dirty];
+    CGContextRestoreGState(cacheContext);
+}
+
+/* Redraw several regions, one at a time. Subclasses whose layout work doesn't split by region can redraw them in one pass */
+- (void)redrawCacheRects:(const CGRect *)rects count:(int)count {
+    
+    for (int i = 0; i < count; i++)
+        [self redrawCacheRect:rects[i]];
+}
+
+- (void)updateCache {
+    
+    ScopeLayoutState state = [self currentLayoutState];
+    CGFloat scale = [UIScreen mainScreen].scale;    // contentScaleFactor is 1 for views without drawRect
+    CGRect bounds = CGRectMake(0, 0, state.width, state.height);
+    float dx, dy;
+    
+    ScopeLayoutChange change = kScopeLayoutRedraw;
+    if (cacheValid && scale == cacheScale)
+        change = scopeLayoutCompare(&cachedState, &state, scale, &dx, &dy);
+    
+    if (change == kScopeLayoutUnchanged)
+        return;
+    
+    if (change == kScopeLayoutRedraw) {
+        
+        if (![self allocateCacheWithState:&state scale:scale]) {
+            cacheValid = false;
+            return;
+        }
+        
+        cachedState = state;
+        cacheScale = scale;
+        
+        UIGraphicsPushContext(cacheContext);
+        [self redrawCacheRect:bounds];
+        UIGraphicsPopContext();
+    }
+    else {
+        
+        /* Keep the cached spacing (within tolerance) and move the origin by the pixel-aligned shift */
+        cachedState.originX += dx;
+        cachedState.originY += dy;
+        
+        /* Shift the previous contents (the snapshot is copy-on-write, so it survives the clear) */
+        CGContextClearRect(cacheContext, bounds);
+        CGContextSaveGState(cacheContext);
+        CGContextTranslateCTM(cacheContext, dx, dy + state.height);
+        CGContextScaleCTM(cacheContext, 1.0, -1.0);
+        CGContextDrawImage(cacheContext, bounds, cacheImage);
+        CGContextRestoreGState(cacheContext);
+        
+        /* Redraw only what the shift exposed or displaced */
+        ScopeRect bands[kScopeMaxFixedBands];
+        ScopeRect dirty[kScopeMaxDirtyRects];
+        int nBands = [self getFixedBands:bands];
+        int nDirty = scopeLayoutDirtyRects(state.width, state.height, dx, dy, bands, nBands, dirty);
+        
+        CGRect rects[kScopeMaxDirtyRects];
+        for (int i = 0; i < nDirty; i++)
+            rects[i] = CGRectMake(dirty[i].x, dirty[i].y, dirty[i].width, dirty[i].height);
+        
+        UIGraphicsPushContext(cacheContext);
+        [self redrawCacheRects:rects count:nDirty];
+        UIGraphicsPopContext();
+    }
+    
+    CGImageRelease(cacheImage);
+    cacheImage = CGBitmapContextCreateImage(cacheContext);
+    cacheValid = (cacheImage != NULL);
+}
+@end
+
+#pragma mark -
+#pragma mark METScopeAxisView
+@interface METScopeAxisView : METScopeCachedLayerView
+@end
+
+@implementation METScopeAxisView
+
+/* Axes appear and disappear as they cross the plot bounds */
+- (ScopeLayoutState)currentLayoutState {
+    
+    ScopeLayoutState state = [super currentLayoutState];
+    
+    int style[3];
+    style[0] = parent.visiblePlotMin.y <= 0 && parent.visiblePlotMax.y >= 0;
+    style[1] = parent.visiblePlotMin.x <= 0 && parent.visiblePlotMax.x >= 0;
+    style[2] = (int)lroundf(8 * [parent plotScaleToPixel:0.0 y:parent.visiblePlotMax.y].y);   // Constant unless the y-axis is log-scaled
+    state.style = scopeLayoutHash(0, style, sizeof(style));
+    
+    return state;
+}
+
+/* Draw axes and ticks within the dirty rect as a single path */
+- (void)drawLayerWithState:(const ScopeLayoutState *)state inContext:(CGContextRef)context dirtyRect:(CGRect)dirty {
+    
+    ScopeTicks ticks;
     
     CGContextSetStrokeColorWithColor(context, [UIColor blackColor].CGColor);
     CGContextSetAlpha(context, 1.0);
@@ -378,209 +581,266 @@
     /* If the x-axis is within the plot's bounds */
     if(parent.visiblePlotMin.y <= 0 && parent.visiblePlotMax.y >= 0) {
         
-        loc = [parent plotScaleToPixel:parent.visiblePlotMin.x y:0.0];
-        
-        /* Draw the x-axis */
-        CGContextMoveToPoint(context, loc.x, loc.y);
-        CGContextAddLineToPoint(context, self.frame.size.width, loc.y);
-        CGContextStrokePath(context);
+        /* The x-axis */
+        CGContextMoveToPoint(context, 0, state->originY);
+        CGContextAddLineToPoint(context, state->width, state->originY);
         
-        /* Starting at the plot origin, draw ticks in the positive x direction */
-        loc = parent.originPixel;
-        while(loc.x <= self.bounds.size.width) {
-            
-            CGContextMoveToPoint(context, loc.x, loc.y - 3);
-            CGContextAddLineToPoint(context, loc.x, loc.y + 3);
-            CGContextStrokePath(context);
-            
-            loc.x += parent.tickPixels.x;
-        }
-        
-        /* Draw ticks in negative x direction */
-        loc = parent.originPixel;
-        while(loc.x >= 0) {
-            
-            CGContextMoveToPoint(context, loc.x, loc.y - 3);
-            CGContextAddLineToPoint(context, loc.x, loc.y + 3);
-            CGContextStrokePath(context);
-            
-            loc.x -= parent.tickPixels.x;
+        /* Ticks, spaced from the plot origin */
+        scopeTicksCompute(&ticks, state->originX, state->tickPixelsX,
+                          CGRectGetMinX(dirty) - 1, CGRectGetMaxX(dirty) + 1);
+        for (int i = 0; i < ticks.nTicks; i++) {
+            CGContextMoveToPoint(context, ticks.pixel[i], state->originY - 3);
+            CGContextAddLineToPoint(context, ticks.pixel[i], state->originY + 3);
         }
     }
     
     /* If the y-axis is within the plot's bounds */
     if(parent.visiblePlotMin.x <= 0 && parent.visiblePlotMax.x >= 0) {
         
-        loc = [parent plotScaleToPixel:0.0 y:parent.visiblePlotMax.y];
-        
-        /* Draw the y-axis */
-        CGContextMoveToPoint(context, loc.x, loc.y);
-        CGContextAddLineToPoint(context, loc.x, self.frame.size.height);
-        CGContextStrokePath(context);
+        /* The y-axis */
+        CGPoint top = [parent plotScaleToPixel:0.0 y:parent.visiblePlotMax.y];
+        CGContextMoveToPoint(context, state->originX, top.y - self.frame.origin.y);
+        CGContextAddLineToPoint(context, state->originX, state->height);
         
-        /* Starting at the plot origin, draw ticks in the positive y direction */
-        loc = parent.originPixel;
-        while(loc.y <= self.bounds.size.height) {
-            
-            CGContextMoveToPoint(context, loc.x - 3, loc.y);
-            CGContextAddLineToPoint(context, loc.x + 3, loc.y);
-            CGContextStrokePath(context);
-            
-            loc.y += parent.tickPixels.y;
-        }
-        
-        /* Draw ticks in negative y direction */
-        loc = parent.originPixel;
-        while(loc.y >= 0) {
-            
-            CGContextMoveToPoint(context, loc.x - 3, loc.y);
-            CGContextAddLineToPoint(context, loc.x + 3, loc.y);
-            CGContextStrokePath(context);
-            
-            loc.y -= parent.tickPixels.y;
+        scopeTicksCompute(&ticks, state->originY, state->tickPixelsY,
+                          CGRectGetMinY(dirty) - 1, CGRectGetMaxY(dirty) + 1);
+        for (int i = 0; i < ticks.nTicks; i++) {
+            CGContextMoveToPoint(context, state->originX - 3, ticks.pixel[i]);
+            CGContextAddLineToPoint(context, state->originX + 3, ticks.pixel[i]);
         }
     }
+    
+    CGContextStrokePath(context);
 }
 @end
 
 #pragma mark -
 #pragma mark METScopeGridView
-@interface METScopeGridView : UIView {
-    float gridDashLengths[2];
+@interface METScopeGridView : METScopeCachedLayerView {
+    CGFloat gridDashLengths[2];
 }
-@property METScopeView *parent;
 @end
 
 @implementation METScopeGridView
-@synthesize parent;
 
-/* Create a transparent subview using the parent's frame */
 - (id)initWithParentView:(METScopeView *)parentView {
     
-    CGRect frame = parentView.frame;
-    frame.origin.x = frame.origin.y = 0;
-    
-    self = [super initWithFrame:frame];
+    self = [super initWithParentView:parentView];
     
     if (self) {
-        [self setBackgroundColor:[UIColor clearColor]];
-        parent = parentView;
         gridDashLengths[0] = self.bounds.size.width  / 100;
         gridDashLengths[1] = self.bounds.size.height / 100;
     }
     return self;
 }
 
-- (void)drawRect:(CGRect)rect {
+/* Dash phase that keeps the dash pattern fixed to the plot (not the view) so shifted and redrawn regions line up */
+- (CGFloat)dashPhaseForOrigin:(float)origin {
     
-    CGContextRef context = UIGraphicsGetCurrentContext();
-    CGPoint loc;            // Reusable current location
+    CGFloat period = gridDashLengths[0] + gridDashLengths[1];
+    CGFloat phase = fmod(M_PI - origin, period);
+    
+    return (phase < 0) ? phase + period : phase;
+}
+
+/* Draw the grid lines within the dirty rect, one path per direction */
+- (void)drawLayerWithState:(const ScopeLayoutState *)state inContext:(CGContextRef)context dirtyRect:(CGRect)dirty {
+    
+    ScopeTicks ticks;
     
     /* Dashed-line parameters */
     CGContextSetStrokeColorWithColor(context, [UIColor blackColor].CGColor);
     CGContextSetAlpha(context, 0.5);
     CGContextSetLineWidth(context, 0.3);
-    CGContextSetLineDash(context, M_PI, (CGFloat *)&gridDashLengths, 2);
-    
-    loc.y = 0;
-    loc.x = parent.originPixel.x;
     
-    /* Draw in-bound vertical grid lines in positive x direction until we excede the frame width */
-    while (loc.x < 0) loc.x += parent.tickPixels.x;
-    while (loc.x <= self.bounds.size.width) {
-        
-        CGContextMoveToPoint(context, loc.x, loc.y);
-        CGContextAddLineToPoint(context, loc.x, self.bounds.size.height);
-        CGContextStrokePath(context);
-        
-        loc.x += parent.tickPixels.x;
-    }
-    
-    loc.y = 0;
-    loc.x = parent.originPixel.x;
-    
-    /* Draw in-bound vertical grid lines in negative x direction until we pass zero */
-    while (loc.x > self.bounds.size.width) loc.x -= parent.tickPixels.x;
-    while (loc.x >= 0) {
-        
-        CGContextMoveToPoint(context, loc.x, loc.y);
-        CGContextAddLineToPoint(context, loc.x, self.bounds.size.height);
-        CGContextStrokePath(context);
-        
-        loc.x -= parent.tickPixels.x;
+    /* Vertical grid lines */
+    scopeTicksCompute(&ticks, state->originX, state->tickPixelsX,
+                      fmaxf(CGRectGetMinX(dirty) - 1, 0), fminf(CGRectGetMaxX(dirty) + 1, state->width));
+    for (int i = 0; i < ticks.nTicks; i++) {
+        CGContextMoveToPoint(context, ticks.pixel[i], 0);
+        CGContextAddLineToPoint(context, ticks.pixel[i], state->height);
     }
-    
-    loc.x = 0;
-    loc.y = parent.originPixel.y;
-    
-    /* Draw in-bound horizontal grid lines in negative y direction until we excede the frame height */
-    while (loc.y < 0) loc.y += parent.tickPixels.y;
-    while (loc.y <= self.bounds.size.height) {
-        
-        CGContextMoveToPoint(context, loc.x, loc.y);
-        CGContextAddLineToPoint(context, self.bounds.size.width, loc.y);
-        CGContextStrokePath(context);
-        
-        loc.y += parent.tickPixels.y;
-    }
-    
-    loc.x = 0;
-    loc.y = parent.originPixel.y;
-    
-    /* Draw in-bound horizontal grid lines in positive y direction until we excede 0 */
-    while (loc.y > self.bounds.size.height) loc.y -= parent.tickPixels.y;
-    while (loc.y >= 0) {
-        
-        CGContextMoveToPoint(context, loc.x, loc.y);
-        CGContextAddLineToPoint(context, self.bounds.size.width, loc.y);
-        CGContextStrokePath(context);
-        
-        loc.y -= parent.tickPixels.y;
+    CGContextSetLineDash(context, [self dashPhaseForOrigin:state->originY], gridDashLengths, 2);
+    CGContextStrokePath(context);
+    
+    /* Horizontal grid lines */
+    scopeTicksCompute(&ticks, state->originY, state->tickPixelsY,
+                      fmaxf(CGRectGetMinY(dirty) - 1, 0), fminf(CGRectGetMaxY(dirty) + 1, state->height));
+    for (int i = 0; i < ticks.nTicks; i++) {
+        CGContextMoveToPoint(context, 0, ticks.pixel[i]);
+        CGContextAddLineToPoint(context, state->width, ticks.pixel[i]);
     }
+    CGContextSetLineDash(context, [self dashPhaseForOrigin:state->originX], gridDashLengths, 2);
+    CGContextStrokePath(context);
 }
 @end
 
 #pragma mark -
 #pragma mark METScopeLabelView
-@interface METScopeLabelView : UIView {
+/* Rendered label images are cached by formatted value, so a redraw only formats into a stack buffer and blits */
+#define METScopeLabelView_GlyphCacheCapacity 256
+#define METScopeLabelView_FixedBandPadding 12
+#define METScopeLabelView_MaxLabelWidth 64        // Bounds on a label glyph's size, for finding the labels that can reach a dirty rect
+#define METScopeLabelView_MaxLabelHeight 16
+
+static void releaseLabelGlyph(void *glyph) {
+    CFRelease(glyph);
+}
+
+static bool rectReachesAny(CGRect rect, const CGRect *rects, int count) {
+    
+    for (int i = 0; i < count; i++)
+        if (CGRectIntersectsRect(rect, rects[i]))
+            return true;
+    return false;
+}
+
+@interface METScopeLabelView : METScopeCachedLayerView {
     NSDictionary *labelAttributes;
-    CGPoint pixelOffset;
+    ScopeLabelCache *glyphCache;
 }
-@property METScopeView *parent;
 @end
 
 @implementation  METScopeLabelView
-@synthesize parent;
 
-/* Create a transparent subview using the parent's frame */
 - (id)initWithParentView:(METScopeView *)parentView {
     
-    CGRect frame = parentView.frame;
-    frame.origin.x = frame.origin.y = 0;
-    
-    self = [super initWithFrame:frame];
+    self = [super initWithParentView:parentView];
     
     if (self) {
-        [self setBackgroundColor:[UIColor clearColor]];
-        parent = parentView;
         labelAttributes = @{NSFontAttributeName:[UIFont fontWithName:@"Arial" size:11],
                             NSParagraphStyleAttributeName:[NSMutableParagraphStyle defaultParagraphStyle],
                             NSForegroundColorAttributeName:[UIColor grayColor]};
-        pixelOffset = parentView.frame.origin;
+        glyphCache = scopeLabelCacheCreate(METScopeLabelView_GlyphCacheCapacity, releaseLabelGlyph);
     }
     return self;
 }
 
-- (void)drawRect:(CGRect)rect {
+- (void)dealloc {
+    
+    scopeLabelCacheDestroy(glyphCache);
+}
+
+/* Label formats, positions and (for labels on the axes) axis visibility all change the rendering */
+- (ScopeLayoutState)currentLayoutState {
+    
+    ScopeLayoutState state = [super currentLayoutState];
+    
+    int style[6];
+    style[0] = parent.xLabelsOn;
+    style[1] = parent.yLabelsOn;
+    style[2] = parent.xLabelPosition;
+    style[3] = parent.yLabelPosition;
+    style[4] = parent.visiblePlotMin.y <= 0 && parent.visiblePlotMax.y >= 0;
+    style[5] = parent.visiblePlotMin.x <= 0 && parent.visiblePlotMax.x >= 0;
     
-    if (parent.xLabelsOn)   [self drawXLabels];
-    if (parent.yLabelsOn)   [self drawYLabels];
+    const char *xFormat = [parent.xLabelFormatString UTF8String];
+    const char *yFormat = [parent.yLabelFormatString UTF8String];
+    
+    uint32_t hash = scopeLayoutHash(0, style, sizeof(style));
+    hash = scopeLayoutHash(hash, xFormat, strlen(xFormat) + 1);
+    hash = scopeLayoutHash(hash, yFormat, strlen(yFormat) + 1);
+    state.style = hash;
+    
+    return state;
+}
+
+/* Labels outside the plot area stay put along one axis while panning */
+- (int)getFixedBands:(ScopeRect *)bands {
+    
+    int n = 0;
+    CGSize size = self.bounds.size;
+    
+    if (parent.xLabelsOn && parent.xLabelPosition == kMETScopeViewXLabelsOutsideBelow) {
+        float height = METScopeView_XLabel_Outside_Extension + METScopeLabelView_FixedBandPadding;
+        bands[n++] = (ScopeRect){0, size.height - height, size.width, height};
+    }
+    else if (parent.xLabelsOn && parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove)
+        bands[n++] = (ScopeRect){0, 0, size.width, METScopeView_XLabel_Outside_Extension + METScopeLabelView_FixedBandPadding};
+    
+    if (parent.yLabelsOn && parent.yLabelPosition == kMETScopeViewYLabelsOutsideLeft)
+        bands[n++] = (ScopeRect){0, 0, METScopeview_YLabel_Outside_Extension + METScopeLabelView_FixedBandPadding, size.height};
+    else if (parent.yLabelsOn && parent.yLabelPosition == kMETScopeViewYLabelsOutsideRight) {
+        float width = METScopeview_YLabel_Outside_Extension + METScopeLabelView_FixedBandPadding;
+        bands[n++] = (ScopeRect){size.width - width, 0, width, size.height};
+    }
+    
+    return n;
+}
+
+- (void)drawLayerWithState:(const ScopeLayoutState *)state inContext:(CGContextRef)context dirtyRect:(CGRect)dirty {
+    
+    [self drawLabelsWithState:state dirtyRects:&dirty count:1];
+}
+
+/* Lay the labels out once for all the regions a pan dirtied, so a label reaching several of them is only looked up once */
+- (void)redrawCacheRects:(const CGRect *)rects count:(int)count {
+    
+    CGContextSaveGState(cacheContext);
+    CGContextClipToRects(cacheContext, rects, count);
+    for (int i = 0; i < count; i++)
+        CGContextClearRect(cacheContext, rects[i]);
+    [self drawLabelsWithState:&cachedState dirtyRects:rects count:count];
+    CGContextRestoreGState(cacheContext);
+}
+
+- (void)drawLabelsWithState:(const ScopeLayoutState *)state dirtyRects:(const CGRect *)rects count:(int)count {
+    
+    scopeLabelCacheSetTickState(glyphCache, state);
+    
+    if (parent.xLabelsOn)   [self drawXLabelsWithState:state dirtyRects:rects count:count];
+    if (parent.yLabelsOn)   [self drawYLabelsWithState:state dirtyRects:rects count:count];
+}
+
+/* Image of a label, rendered once per distinct string */
+- (UIImage *)glyphForLabel:(const char *)text {
+    
+    UIImage *glyph = (__bridge UIImage *)scopeLabelCacheFind(glyphCache, text);
+    if (glyph)
+        return glyph;
+    
+    NSString *label = [NSString stringWithUTF8String:text];
+    CGSize size = [label sizeWithAttributes:labelAttributes];
+    size.width = ceil(size.width);
+    size.height = ceil(size.height);
+    
+    UIGraphicsBeginImageContextWithOptions(size, NO, cacheScale);
+    [label drawAtPoint:CGPointZero withAttributes:labelAttributes];
+    glyph = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    
+    void *retained = (void *)CFBridgingRetain(glyph);
+    if (!scopeLabelCacheInsert(glyphCache, text, retained))
+        CFRelease(retained);
+    
+    return glyph;
 }
 
-- (void)drawXLabels {
+/* Label for tick index on an axis, if it can reach a dirty rect. Within a pan the tick's glyph is reused without formatting the label */
+- (void)drawLabelForAxis:(ScopeAxis)axis index:(int)index format:(const char *)format value:(double)value atPoint:(CGPoint)loc
+              dirtyRects:(const CGRect *)rects count:(int)count {
+    
+    CGRect extent = CGRectMake(loc.x, loc.y, METScopeLabelView_MaxLabelWidth, METScopeLabelView_MaxLabelHeight);
+    if (!rectReachesAny(extent, rects, count))
+        return;
+    
+    UIImage *glyph = (__bridge UIImage *)scopeLabelCacheFindTick(glyphCache, axis, index);
+    
+    if (!glyph) {
+        char text[kScopeLabelMaxLength * 2];
+        scopeFormatLabel(text, sizeof(text), format, value);
+        glyph = [self glyphForLabel:text];
+        scopeLabelCacheInsertTick(glyphCache, axis, index, text);
+    }
+    
+    if (rectReachesAny(CGRectMake(loc.x, loc.y, glyph.size.width, glyph.size.height), rects, count))
+        [glyph drawAtPoint:loc];
+}
+
+- (void)drawXLabelsWithState:(const ScopeLayoutState *)state dirtyRects:(const CGRect *)rects count:(int)count {
     
     CGPoint loc;            // Current point in pixels
-    NSString *label;
+    ScopeTicks ticks;
     
     /* If we're drawing labels on the axes and the x-axis isn't within the plot bounds, do nothing */
     if ((parent.xLabelPosition == kMETScopeViewXLabelsBelowAxis ||
@@ -588,113 +848,88 @@
         (parent.visiblePlotMin.y > 0 || parent.visiblePlotMax.y < 0))
         return;
     
-    /* ---------------------------- */
-    /* === Positive x direction === */
-    /* ---------------------------- */
-    
-    /* Determine starting point for drawing labels based on specified position */
-    loc = parent.originPixel;
+    /* Determine the vertical position based on specified position */
+    loc.y = state->originY;
     loc.y +=  2 * (parent.xLabelPosition == kMETScopeViewXLabelsBelowAxis);
     loc.y -= 13 * (parent.xLabelPosition == kMETScopeViewXLabelsAboveAxis);
-    loc.y = (parent.xLabelPosition == kMETScopeViewXLabelsOutsideBelow) ? self.bounds.size.height - 13 : loc.y;
-    loc.x += (parent.yLabelPosition == kMETScopeViewYLabelsOutsideLeft) ? METScopeview_YLabel_Outside_Extension : 0;
-    loc.y = (parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove) ? self.bounds.origin.y : loc.y;
+    loc.y = (parent.xLabelPosition == kMETScopeViewXLabelsOutsideBelow) ? state->height - 13 : loc.y;
+    loc.y = (parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove) ? 0 : loc.y;
     
     int labelCenter = ((parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove) ||
                        (parent.xLabelPosition == kMETScopeViewXLabelsOutsideBelow)) ? -14 : 2;
-    while(loc.x <= self.bounds.size.width) {
-        
-        loc.x += self.frame.origin.x;
-        label = [NSString stringWithFormat:parent.xLabelFormatString, [parent pixelToPlotScale:loc withOffset:pixelOffset].x];
-        loc.x -= self.frame.origin.x;
-        loc.x += labelCenter;
-        [label drawAtPoint:loc withAttributes:labelAttributes];
-        loc.x -= labelCenter;
-        loc.x += parent.tickPixels.x;
+    
+    /* Ticks whose labels can reach a dirty rect crossing the label row */
+    CGFloat minPixel = state->width, maxPixel = 0;
+    for (int i = 0; i < count; i++) {
+        if (CGRectGetMaxY(rects[i]) < loc.y || CGRectGetMinY(rects[i]) > loc.y + 2 + METScopeLabelView_MaxLabelHeight)
+            continue;
+        minPixel = fmin(minPixel, CGRectGetMinX(rects[i]) - labelCenter - METScopeLabelView_MaxLabelWidth);
+        maxPixel = fmax(maxPixel, CGRectGetMaxX(rects[i]) - labelCenter);
     }
     
-    /* ---------------------------- */
-    /* === Negative x direction === */
-    /* ---------------------------- */
+    const char *format = [parent.xLabelFormatString UTF8String];
     
-    /* Determine starting point for drawing labels based on specified position */
-    loc = parent.originPixel;
-    loc.x -= parent.tickPixels.x;
-    loc.y +=  2 * (parent.xLabelPosition == kMETScopeViewXLabelsBelowAxis);
-    loc.y -= 13 * (parent.xLabelPosition == kMETScopeViewXLabelsAboveAxis);
-    loc.y = (parent.xLabelPosition == kMETScopeViewXLabelsOutsideBelow) ? self.bounds.size.height - 13 : loc.y;
-    loc.x += (parent.yLabelPosition == kMETScopeViewYLabelsOutsideLeft) ? METScopeview_YLabel_Outside_Extension : 0;
-    loc.y = (parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove) ? self.bounds.origin.y : loc.y;
-    
-    loc.y += 2;
-    while(loc.x >= 0) {
+    /* Label every tick in the frame; labels left of the origin sit 2 pixels lower */
+    scopeTicksCompute(&ticks, state->originX, state->tickPixelsX, fmax(minPixel, 0), fmin(maxPixel, state->width));
+    for (int i = 0; i < ticks.nTicks; i++) {
         
-        loc.x += self.frame.origin.x;
-        label = [NSString stringWithFormat:parent.xLabelFormatString, [parent pixelToPlotScale:loc withOffset:pixelOffset].x];
-        loc.x -= self.frame.origin.x;
-        loc.x += labelCenter;
-        [label drawAtPoint:loc withAttributes:labelAttributes];
-        loc.x -= labelCenter;
-        loc.x -= parent.tickPixels.x;
+        CGPoint labelLoc = CGPointMake(ticks.pixel[i] + labelCenter, loc.y + 2 * (ticks.index[i] < 0));
+        [self drawLabelForAxis:kScopeAxisX index:ticks.index[i] format:format value:ticks.index[i] * state->tickUnitsX
+                       atPoint:labelLoc dirtyRects:rects count:count];
     }
 }
 
-- (void)drawYLabels {
+- (void)drawYLabelsWithState:(const ScopeLayoutState *)state dirtyRects:(const CGRect *)rects count:(int)count {
     
-    CGPoint loc;        // Current points in pixels
-    NSString *label;
+    ScopeTicks ticks;
     
     /* If we're drawing labels on the axes and the y-axis isn't within the plot bounds, do nothing */
     if ((parent.yLabelPosition == kMETScopeViewYLabelsAtAxisLeft   ||
          parent.yLabelPosition == kMETScopeViewYLabelsAtAxisRight) &&
         (parent.visiblePlotMin.x > 0 || parent.visiblePlotMax.x < 0))
         return;
-        
-    /* ---------------------------- */
-    /* === Positive y direction === */
-    /* ---------------------------- */
-    
-    loc = parent.originPixel;
-    loc.x +=  2 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisRight);
-    loc.x -= 25 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisLeft);
-    loc.x = (parent.yLabelPosition == kMETScopeViewYLabelsOutsideLeft) ? self.bounds.origin.x : loc.x;
-    loc.y += (parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove) ? METScopeView_XLabel_Outside_Extension : 0;
-    loc.x = (parent.yLabelPosition == kMETScopeViewYLabelsOutsideRight) ? self.bounds.size.width - METScopeview_YLabel_Outside_Extension : loc.x;
-    
-    loc.x += 2;
-    while(loc.y <= self.bounds.size.height) {
-        
-        loc.y += self.frame.origin.y;
-        label = [NSString stringWithFormat:parent.yLabelFormatString, [parent pixelToPlotScale:loc withOffset:pixelOffset].y];
-        loc.y -= self.frame.origin.y;
-        loc.y -= 14;
-        [label drawAtPoint:loc withAttributes:labelAttributes];
-        loc.y += 14;
-        loc.y += parent.tickPixels.y;
-    }
     
-    /* ---------------------------- */
-    /* === Negative y direction === */
-    /* ---------------------------- */
+    /* Horizontal positions below (ticks at and below the origin) and above (at and above) the origin */
+    CGFloat xBelow = state->originX, xAbove = state->originX;
+    xBelow +=  2 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisRight);
+    xBelow -= 25 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisLeft);
+    xAbove +=  2 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisRight);
+    xAbove -= 23 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisLeft);
+    
+    if (parent.yLabelPosition == kMETScopeViewYLabelsOutsideLeft)
+        xBelow = xAbove = 0;
+    else if (parent.yLabelPosition == kMETScopeViewYLabelsOutsideRight)
+        xBelow = xAbove = state->width - METScopeview_YLabel_Outside_Extension;
+    xBelow += 2;
+    xAbove += 2;
+    
+    /* Ticks whose labels can reach a dirty rect crossing the label column */
+    CGFloat minPixel = state->height, maxPixel = 0;
+    for (int i = 0; i < count; i++) {
+        if (CGRectGetMaxX(rects[i]) < fmin(xBelow, xAbove) ||
+            CGRectGetMinX(rects[i]) > fmax(xBelow, xAbove) + METScopeLabelView_MaxLabelWidth)
+            continue;
+        minPixel = fmin(minPixel, CGRectGetMinY(rects[i]) + 14 - METScopeLabelView_MaxLabelHeight);
+        maxPixel = fmax(maxPixel, CGRectGetMaxY(rects[i]) + 14);
+    }
     
-    loc = parent.originPixel;
-    loc.x +=  2 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisRight);
-    loc.x -= 23 * (parent.yLabelPosition == kMETScopeViewYLabelsAtAxisLeft);
-    loc.x = (parent.yLabelPosition == kMETScopeViewYLabelsOutsideLeft) ? self.bounds.origin.x : loc.x;
-    loc.y += (parent.xLabelPosition == kMETScopeViewXLabelsOutsideAbove) ? METScopeView_XLabel_Outside_Extension : 0;
-    loc.x = (parent.yLabelPosition == kMETScopeViewYLabelsOutsideRight) ? self.bounds.size.width - METScopeview_YLabel_Outside_Extension : loc.x;
+    const char *format = [parent.yLabelFormatString UTF8String];
     
+    /* Plot value at the origin pixel (semilog-y maps 0 to its floor) */
+    double originValue = (parent.axisScale == kMETScopeViewAxesSemilogY) ? 20 * log10f(10e-16) : 0.0;
     
-    loc.x += 2;
-    while(loc.y >= 0) {
+    /* Pixels increase downward, so tick k is at value -k * tickUnits. The origin's label is drawn from both sides */
+    scopeTicksCompute(&ticks, state->originY, state->tickPixelsY, fmax(minPixel, 0), fmin(maxPixel, state->height));
+    for (int i = 0; i < ticks.nTicks; i++) {
         
-        loc.y += self.frame.origin.y;
-        label = [NSString stringWithFormat:parent.yLabelFormatString, [parent pixelToPlotScale:loc withOffset:pixelOffset].y];
-        loc.y -= self.frame.origin.y;
-        loc.y -= 14;
-        [label drawAtPoint:loc withAttributes:labelAttributes];
-        loc.y += 14;
-        loc.y -= parent.tickPixels.y;
+        double value = originValue - ticks.index[i] * state->tickUnitsY;
+        
+        if (ticks.index[i] >= 0)
+            [self drawLabelForAxis:kScopeAxisY index:ticks.index[i] format:format value:value
+                           atPoint:CGPointMake(xBelow, ticks.pixel[i] - 14) dirtyRects:rects count:count];
+        if (ticks.index[i] <= 0)
+            [self drawLabelForAxis:kScopeAxisY index:ticks.index[i] format:format value:value
+                           atPoint:CGPointMake(xAbove, ticks.pixel[i] - 14) dirtyRects:rects count:count];
     }
 }
 @end
@@ -1062,40 +1297,20 @@
     visibleRange.x = visiblePlotMax.x - visiblePlotMin.x;
     visibleRange.y = visiblePlotMax.y - visiblePlotMin.y;
     
-    CGPoint ticksInFrame;
-    ticksInFrame.x = visibleRange.x / xTick;
-    ticksInFrame.y = visibleRange.y / yTick;
-    
-    CGPoint orderOfMag;
-    orderOfMag.x = floorf(log10f(visibleRange.x)) - 1;
-    orderOfMag.y = floorf(log10f(visibleRange.y)) - 1;
+    char format[kScopeLabelMaxLength];
 
     if (xGridAutoScale) {
-        if (ticksInFrame.x > METScopeView_AutoGrid_MaxXTicksInFrame)
-            tickUnits.x = xTick + visibleRange.x / 10;
-        else if (ticksInFrame.x < METScopeView_AutoGrid_MinXTicksInFrame) {
-            tickUnits.x = xTick - visibleRange.x / 10;
-        }
-        else tickUnits.x = xTick;
-        
-        tickUnits.x = floorf(tickUnits.x / powf(10, orderOfMag.x) + 0.5) * powf(10, orderOfMag.x);
-        xLabelFormatString = [NSString stringWithFormat:@"%%%d.%df", (int)fabs(orderOfMag.x)+1,
-                              orderOfMag.x < 0 ? (int)fabs(orderOfMag.x) : 0];
+        tickUnits.x = scopeAutoTickSpacing(visibleRange.x, xTick, METScopeView_AutoGrid_MinXTicksInFrame,
+                                           METScopeView_AutoGrid_MaxXTicksInFrame, format, sizeof(format));
+        xLabelFormatString = [NSString stringWithUTF8String:format];
     }
     else
         tickUnits.x = xTick;
 
     if (yGridAutoScale) {
-        if (ticksInFrame.y > METScopeView_AutoGrid_MaxYTicksInFrame)
-            tickUnits.y = yTick + visibleRange.y / 10;
-        else if (ticksInFrame.y < METScopeView_AutoGrid_MinYTicksInFrame) {
-            tickUnits.y = yTick - visibleRange.y / 10;
-        }
-        else tickUnits.y = yTick;
-        
-        tickUnits.y = floorf(tickUnits.y / powf(10, orderOfMag.y) + 0.5) * powf(10, orderOfMag.y);
-        yLabelFormatString = [NSString stringWithFormat:@"%%%d.%df", (int)fabs(orderOfMag.y)+1,
-                              orderOfMag.y < 0 ? (int)fabs(orderOfMag.y) : 0];
+        tickUnits.y = scopeAutoTickSpacing(visibleRange.y, yTick, METScopeView_AutoGrid_MinYTicksInFrame,
+                                           METScopeView_AutoGrid_MaxYTicksInFrame, format, sizeof(format));
+        yLabelFormatString = [NSString stringWithUTF8String:format];
     }
     else
         tickUnits.y = yTick;
@@ -0,0 +1,361 @@
+//
+//  ScopeLayout.c
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+#include "ScopeLayout.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void scopeTicksCompute(ScopeTicks *ticks, float origin, float spacing, float minPixel, float maxPixel) {
+
+    ticks->nTicks = 0;
+
+    if (!(spacing > 0.0f) || !isfinite(origin) || minPixel > maxPixel)
+        return;
+
+    /* Small epsilon so ticks landing exactly on the bounds survive rounding */
+    double first = ceil((minPixel - (double)origin) / spacing - 1e-6);
+    double last = floor((maxPixel - (double)origin) / spacing + 1e-6);
+
+    if (last < first)
+        return;
+    if (last - first >= kScopeMaxTicks)
+        last = first + kScopeMaxTicks - 1;
+
+    /* An origin far off-screen (or extreme zoom) puts the tick indices out of int range; there's nothing sensible to label */
+    if (!(first >= INT_MIN && last <= INT_MAX))
+        return;
+
+    for (double k = first; k <= last; k++) {
+        ticks->index[ticks->nTicks] = (int)k;
+        ticks->pixel[ticks->nTicks] = (float)(origin + k * spacing);
+        ticks->nTicks++;
+    }
+}
+
+/* Whether ticks at the cached spacing stay within tolerance of the current ones across the view */
+static int spacingMatches(float cached, float current, float length) {
+
+    if (cached == current)
+        return 1;
+    if (!(cached > 0.0f) || !(current > 0.0f))
+        return 0;
+
+    return fabsf(current - cached) * (length / current + 1.0f) <= kScopeLayoutTolerance;
+}
+
+static int unitsMatch(float cached, float current) {
+
+    return fabsf(current - cached) <= 1e-6f * fabsf(current);
+}
+
+ScopeLayoutChange scopeLayoutCompare(const ScopeLayoutState *cached, const ScopeLayoutState *current,
+                                     float pixelScale, float *dx, float *dy) {
+
+    *dx = *dy = 0.0f;
+
+    if (cached->width != current->width || cached->height != current->height ||
+        cached->axisScale != current->axisScale || cached->style != current->style)
+        return kScopeLayoutRedraw;
+
+    if (!unitsMatch(cached->tickUnitsX, current->tickUnitsX) ||
+        !unitsMatch(cached->tickUnitsY, current->tickUnitsY) ||
+        !spacingMatches(cached->tickPixelsX, current->tickPixelsX, current->width) ||
+        !spacingMatches(cached->tickPixelsY, current->tickPixelsY, current->height))
+        return kScopeLayoutRedraw;
+
+    double shiftX = (double)current->originX - cached->originX;
+    double shiftY = (double)current->originY - cached->originY;
+
+    if (!isfinite(shiftX) || !isfinite(shiftY))
+        return kScopeLayoutRedraw;
+
+    /* Nothing of the cache would remain in view */
+    if (fabs(shiftX) >= current->width || fabs(shiftY) >= current->height)
+        return kScopeLayoutRedraw;
+
+    *dx = (float)(round(shiftX * pixelScale) / pixelScale);
+    *dy = (float)(round(shiftY * pixelScale) / pixelScale);
+
+    if (*dx == 0.0f && *dy == 0.0f)
+        return kScopeLayoutUnchanged;
+
+    return kScopeLayoutTranslated;
+}
+
+static ScopeRect scopeRectMake(float x, float y, float width, float height) {
+    ScopeRect r;
+    r.x = x;
+    r.y = y;
+    r.width = width;
+    r.height = height;
+    return r;
+}
+
+static int scopeRectsOverlap(ScopeRect a, ScopeRect b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static int scopeRectContains(ScopeRect outer, ScopeRect inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+}
+
+static ScopeRect scopeRectUnion(ScopeRect a, ScopeRect b) {
+    float x = fminf(a.x, b.x);
+    float y = fminf(a.y, b.y);
+    return scopeRectMake(x, y, fmaxf(a.x + a.width, b.x + b.width) - x, fmaxf(a.y + a.height, b.y + b.height) - y);
+}
+
+/* Add an exposed edge unless a fixed band's rect already covers it */
+static int addEdge(ScopeRect *dirty, int n, int nBandRects, ScopeRect edge) {
+
+    for (int i = 0; i < nBandRects; i++)
+        if (scopeRectContains(dirty[i], edge))
+            return n;
+
+    dirty[n] = edge;
+    return n + 1;
+}
+
+int scopeLayoutDirtyRects(float width, float height, float dx, float dy,
+                          const ScopeRect *fixedBands, int nFixedBands, ScopeRect *dirty) {
+
+    int n = 0;
+
+    /* Fixed content: clear where the shift moved it and redraw where it belongs. A small shift overlaps the two, so they're redrawn as one rect */
+    if (nFixedBands > kScopeMaxFixedBands)
+        nFixedBands = kScopeMaxFixedBands;
+
+    for (int i = 0; i < nFixedBands; i++) {
+        ScopeRect moved = scopeRectMake(fixedBands[i].x + dx, fixedBands[i].y + dy,
+                                        fixedBands[i].width, fixedBands[i].height);
+        if (scopeRectsOverlap(fixedBands[i], moved))
+            dirty[n++] = scopeRectUnion(fixedBands[i], moved);
+        else {
+            dirty[n++] = fixedBands[i];
+            dirty[n++] = moved;
+        }
+    }
+
+    /* Edges exposed by the shift */
+    int nBandRects = n;
+
+    if (dx > 0.0f)
+        n = addEdge(dirty, n, nBandRects, scopeRectMake(0.0f, 0.0f, dx, height));
+    else if (dx < 0.0f)
+        n = addEdge(dirty, n, nBandRects, scopeRectMake(width + dx, 0.0f, -dx, height));
+
+    if (dy > 0.0f)
+        n = addEdge(dirty, n, nBandRects, scopeRectMake(0.0f, 0.0f, width, dy));
+    else if (dy < 0.0f)
+        n = addEdge(dirty, n, nBandRects, scopeRectMake(0.0f, height + dy, width, -dy));
+
+    return n;
+}
+
+uint32_t scopeLayoutHash(uint32_t hash, const void *data, size_t length) {
+
+    const unsigned char *bytes = (const unsigned char *)data;
+
+    if (hash == 0)
+        hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+int scopeFormatLabel(char *label, size_t size, const char *format, double value) {
+
+    if (value == 0.0)
+        value = 0.0;        // -0 -> 0
+
+    return snprintf(label, size, format, value);
+}
+
+float scopeAutoTickSpacing(float range, float tick, float minTicks, float maxTicks, char *format, size_t formatSize) {
+
+    float ticksInFrame = range / tick;
+    float orderOfMag = floorf(log10f(range)) - 1;
+    float step = powf(10, orderOfMag);
+    float newTick = tick;
+
+    if (ticksInFrame > maxTicks)
+        newTick = tick + range / 10;
+    else if (ticksInFrame < minTicks)
+        newTick = tick - range / 10;
+
+    newTick = floorf(newTick / step + 0.5f) * step;
+
+    /* Keep the current spacing if rounding overshoots to the other side of the range, or the grid alternates between the two on every update */
+    if ((ticksInFrame > maxTicks && range / newTick < minTicks) ||
+        (ticksInFrame < minTicks && range / newTick > maxTicks))
+        newTick = tick;
+
+    if (format)
+        snprintf(format, formatSize, "%%%d.%df", (int)fabsf(orderOfMag) + 1, orderOfMag < 0 ? (int)fabsf(orderOfMag) : 0);
+
+    return newTick;
+}
+
+/* == Label Glyph Cache == */
+
+typedef struct ScopeLabelEntry {
+    char label[kScopeLabelMaxLength];
+    void *glyph;                // NULL for an empty slot
+} ScopeLabelEntry;
+
+typedef struct ScopeTickEntry {
+    int index;
+    void *glyph;                // NULL for an empty slot; owned by the label table
+} ScopeTickEntry;
+
+#define kScopeTickSlots 64      // Per axis, direct-mapped by tick index. Far more than the ticks in frame
+
+struct ScopeLabelCache {
+    int capacity;
+    int count;
+    int nSlots;                 // Power of two, at least twice the capacity to keep probes short
+    ScopeLabelEntry *slots;
+    ScopeLabelReleaseFunction release;
+    ScopeTickEntry ticks[2][kScopeTickSlots];
+    ScopeLayoutState tickState; // State the tick glyphs were labeled for (only the units, axis scale and style matter)
+};
+
+static uint32_t labelHash(const char *label) {
+
+    return scopeLayoutHash(0, label, strlen(label));
+}
+
+ScopeLabelCache *scopeLabelCacheCreate(int capacity, ScopeLabelReleaseFunction release) {
+
+    if (capacity < 1)
+        capacity = 1;
+
+    ScopeLabelCache *cache = (ScopeLabelCache *)calloc(1, sizeof(ScopeLabelCache));
+    cache->capacity = capacity;
+    cache->release = release;
+
+    cache->nSlots = 1;
+    while (cache->nSlots < 2 * capacity)
+        cache->nSlots <<= 1;
+    cache->slots = (ScopeLabelEntry *)calloc(cache->nSlots, sizeof(ScopeLabelEntry));
+
+    return cache;
+}
+
+void scopeLabelCacheDestroy(ScopeLabelCache *cache) {
+
+    if (!cache)
+        return;
+
+    scopeLabelCacheClear(cache);
+    free(cache->slots);
+    free(cache);
+}
+
+/* Slot holding label, or the empty slot where it would go */
+static ScopeLabelEntry *findSlot(ScopeLabelCache *cache, const char *label) {
+
+    uint32_t mask = cache->nSlots - 1;
+    uint32_t idx = labelHash(label) & mask;
+
+    while (cache->slots[idx].glyph && strcmp(cache->slots[idx].label, label) != 0)
+        idx = (idx + 1) & mask;
+
+    return &cache->slots[idx];
+}
+
+void *scopeLabelCacheFind(ScopeLabelCache *cache, const char *label) {
+
+    if (strlen(label) >= kScopeLabelMaxLength)
+        return NULL;
+
+    return findSlot(cache, label)->glyph;
+}
+
+int scopeLabelCacheInsert(ScopeLabelCache *cache, const char *label, void *glyph) {
+
+    if (!glyph || strlen(label) >= kScopeLabelMaxLength)
+        return 0;
+
+    ScopeLabelEntry *slot = findSlot(cache, label);
+
+    /* Replace an existing glyph for the same label */
+    if (slot->glyph) {
+        if (slot->glyph != glyph) {
+            if (cache->release)
+                cache->release(slot->glyph);
+            memset(cache->ticks, 0, sizeof(cache->ticks));
+        }
+        slot->glyph = glyph;
+        return 1;
+    }
+
+    /* Labels change wholesale with the tick spacing, so start over rather than track recency */
+    if (cache->count >= cache->capacity) {
+        scopeLabelCacheClear(cache);
+        slot = findSlot(cache, label);
+    }
+
+    strcpy(slot->label, label);
+    slot->glyph = glyph;
+    cache->count++;
+
+    return 1;
+}
+
+void scopeLabelCacheClear(ScopeLabelCache *cache) {
+
+    for (int i = 0; i < cache->nSlots; i++) {
+        if (cache->slots[i].glyph && cache->release)
+            cache->release(cache->slots[i].glyph);
+        cache->slots[i].glyph = NULL;
+        cache->slots[i].label[0] = '\0';
+    }
+
+    memset(cache->ticks, 0, sizeof(cache->ticks));
+    cache->count = 0;
+}
+
+void scopeLabelCacheSetTickState(ScopeLabelCache *cache, const ScopeLayoutState *state) {
+
+    if (state->tickUnitsX == cache->tickState.tickUnitsX && state->tickUnitsY == cache->tickState.tickUnitsY &&
+        state->axisScale == cache->tickState.axisScale && state->style == cache->tickState.style)
+        return;
+
+    memset(cache->ticks, 0, sizeof(cache->ticks));
+    cache->tickState = *state;
+}
+
+void *scopeLabelCacheFindTick(ScopeLabelCache *cache, ScopeAxis axis, int index) {
+
+    ScopeTickEntry *entry = &cache->ticks[axis][index & (kScopeTickSlots - 1)];
+
+    return (entry->glyph && entry->index == index) ? entry->glyph : NULL;
+}
+
+void scopeLabelCacheInsertTick(ScopeLabelCache *cache, ScopeAxis axis, int index, const char *label) {
+
+    ScopeTickEntry *entry = &cache->ticks[axis][index & (kScopeTickSlots - 1)];
+
+    entry->index = index;
+    entry->glyph = scopeLabelCacheFind(cache, label);
+}
+
+int scopeLabelCacheCount(ScopeLabelCache *cache) {
+
+    return cache->count;
+}
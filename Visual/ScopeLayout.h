@@ -0,0 +1,132 @@
+//
+//  ScopeLayout.h
+//  DigitalSoundFX
+//
+//  Created by Jeff Gregorio on 10/19/26.
+//  Copyright (c) 2026 Jeff Gregorio. All rights reserved.
+//
+
+/*
+    Portable layout for METScopeView's axis, grid and label layers: tick positions, label formatting, a glyph cache keyed by the formatted label, and the change/dirty-region logic that lets the layers keep a cached raster across pans.
+
+    Each layer caches its rendering along with the ScopeLayoutState it was drawn from. On the next update scopeLayoutCompare() classifies the change:
+
+        kScopeLayoutUnchanged:  draw the cache as is
+        kScopeLayoutTranslated: same tick spacing, scale and style with the origin moved (a pan). Shift the cache by the returned
+                                (device-pixel aligned) offset and redraw only the rects from scopeLayoutDirtyRects()
+        kScopeLayoutRedraw:     tick spacing, axis scale, size or style changed (a zoom, or a pan of a full view). Re-rasterize
+
+    Content that doesn't move with the plot origin (e.g. labels pinned outside the plot area) is passed as fixed bands, which are redrawn at their old and new positions on every translation.
+ */
+
+#ifndef DigitalSoundFX_ScopeLayout_h
+#define DigitalSoundFX_ScopeLayout_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define kScopeMaxTicks 128
+#define kScopeMaxFixedBands 2
+#define kScopeMaxDirtyRects (2 + 2 * kScopeMaxFixedBands)
+
+/* Largest drift (pixels) of any tick from its cached position tolerated before re-rasterizing */
+#define kScopeLayoutTolerance 0.25f
+
+/* Labels longer than this (including the terminator) aren't cached */
+#define kScopeLabelMaxLength 32
+
+typedef struct ScopeRect {
+    float x;
+    float y;
+    float width;
+    float height;
+} ScopeRect;
+
+/* Everything a cached layer's rendering depends on */
+typedef struct ScopeLayoutState {
+    float width;                // View size in points
+    float height;
+    float originX;              // Plot origin in view coordinates
+    float originY;
+    float tickPixelsX;          // Tick spacing in points
+    float tickPixelsY;
+    float tickUnitsX;           // Tick spacing in plot units
+    float tickUnitsY;
+    int axisScale;
+    uint32_t style;             // Hash of anything else affecting the rendering (label formats/positions, visibility)
+} ScopeLayoutState;
+
+typedef enum ScopeLayoutChange {
+    kScopeLayoutUnchanged,
+    kScopeLayoutTranslated,
+    kScopeLayoutRedraw
+} ScopeLayoutChange;
+
+/* Tick k sits at pixel origin + k * spacing and plot value k * tickUnits (-k * tickUnits on the y-axis, where pixels increase downward) */
+typedef struct ScopeTicks {
+    int nTicks;
+    int index[kScopeMaxTicks];
+    float pixel[kScopeMaxTicks];
+} ScopeTicks;
+
+/* Ticks within [minPixel, maxPixel] in increasing pixel order. Computed from the origin rather than accumulated, so they don't drift. None if the tick indices would be out of int range */
+void scopeTicksCompute(ScopeTicks *ticks, float origin, float spacing, float minPixel, float maxPixel);
+
+/* Classify the change from the cached state to the current one. For kScopeLayoutTranslated, dx/dy receive the origin shift rounded to whole device pixels (pixelScale = pixels per point); the remainder is under half a device pixel */
+ScopeLayoutChange scopeLayoutCompare(const ScopeLayoutState *cached, const ScopeLayoutState *current,
+                                     float pixelScale, float *dx, float *dy);
+
+/* Regions to redraw after shifting a width x height cache by (dx, dy): each fixed band at its current position and where the shift moved it (one rect when they overlap), plus the exposed edges not already covered. Returns the number of rects written (at most kScopeMaxDirtyRects) */
+int scopeLayoutDirtyRects(float width, float height, float dx, float dy,
+                          const ScopeRect *fixedBands, int nFixedBands, ScopeRect *dirty);
+
+/* FNV-1a, for building ScopeLayoutState.style. Start with hash = 0 */
+uint32_t scopeLayoutHash(uint32_t hash, const void *data, size_t length);
+
+/* Format a label with a printf-style format taking one floating point argument. -0 formats as 0 */
+int scopeFormatLabel(char *label, size_t size, const char *format, double value);
+
+/* Grid auto-scaling: step the tick spacing by a tenth of the visible range toward [minTicks, maxTicks] ticks in frame, rounded to a tenth of the range's order of magnitude. Returns the new spacing and writes the matching label format (if format isn't NULL) */
+float scopeAutoTickSpacing(float range, float tick, float minTicks, float maxTicks, char *format, size_t formatSize);
+
+/* == Label Glyph Cache == */
+
+/* Rendered label glyphs, keyed by the formatted label. The cache owns each glyph and hands it to the release function when cleared or destroyed. When full, inserting clears the cache first */
+typedef struct ScopeLabelCache ScopeLabelCache;
+typedef void (*ScopeLabelReleaseFunction)(void *glyph);
+
+ScopeLabelCache *scopeLabelCacheCreate(int capacity, ScopeLabelReleaseFunction release);
+void scopeLabelCacheDestroy(ScopeLabelCache *cache);
+
+/* The glyph for label, or NULL on a miss */
+void *scopeLabelCacheFind(ScopeLabelCache *cache, const char *label);
+
+/* Store a glyph, taking ownership. Returns 0 (ownership stays with the caller) if the label is too long to cache */
+int scopeLabelCacheInsert(ScopeLabelCache *cache, const char *label, void *glyph);
+
+void scopeLabelCacheClear(ScopeLabelCache *cache);
+int scopeLabelCacheCount(ScopeLabelCache *cache);
+
+/* Glyphs by tick index, so a pan can reuse a tick's glyph without formatting and hashing its label again. They stay valid while the state's tick units, axis scale and style are unchanged; setting any other state drops them */
+typedef enum ScopeAxis {
+    kScopeAxisX,
+    kScopeAxisY
+} ScopeAxis;
+
+void scopeLabelCacheSetTickState(ScopeLabelCache *cache, const ScopeLayoutState *state);
+
+/* The glyph labeling tick index, or NULL on a miss */
+void *scopeLabelCacheFindTick(ScopeLabelCache *cache, ScopeAxis axis, int index);
+
+/* Point tick index at the cached glyph for label (a no-op if label isn't cached) */
+void scopeLabelCacheInsertTick(ScopeLabelCache *cache, ScopeAxis axis, int index, const char *label);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif